@@ -0,0 +1,324 @@
+#include <base_module.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <display_dummy.hpp>
+#include <hwlib.hpp>
+#include <i2c_bus.hpp>
+#include <mock_spi_bus.hpp>
+#include <ssd1306_oled_buffered.hpp>
+#include <ssd1306_oled_unbuffered.hpp>
+#include <st7735_band_buffered.hpp>
+#include <st7735_buffered.hpp>
+#include <st7735_indexed_buffered.hpp>
+#include <st7735_rgb332_buffered.hpp>
+#include <st7735_unbuffered.hpp>
+
+/*
+ * Benchmarks for the display drivers on the native target. All drivers write
+ * to mock buses, so the time is the time of the driver itself.
+ *
+ * Every result is printed as a single line of JSON, so the output of two
+ * runs can be compared by a script:
+ * {"driver": ..., "operation": ..., "size": ..., "iterations": ...,
+ *  "ns_per_op": ..., "pixels_per_s": ..., "bus_bytes_per_op": ...,
+ *  "bus_transactions_per_op": ...}
+ *
+ * The minimal time of every measurement in milliseconds can be given as the
+ * first argument.
+ */
+
+// The minimal time of a single measurement
+static std::chrono::nanoseconds minimal_duration = std::chrono::milliseconds(50);
+
+/*
+ * Bus of the dummy display, nothing is ever written to it.
+ */
+struct no_bus_s {
+    std::size_t bytes_written = 0;
+};
+
+/*
+ * The amount of transactions that have been started on a bus. A transaction
+ * on the spi bus starts by selecting the chip, every write on the i2c bus is
+ * a transaction of its own.
+ */
+std::size_t transactions(const r2d2::display::mock_spi_bus_c &bus) {
+    return bus.cs.transactions;
+}
+
+std::size_t transactions(const r2d2::i2c::i2c_bus_c &bus) {
+    return bus.write_count;
+}
+
+std::size_t transactions(const no_bus_s &) {
+    return 0;
+}
+
+/*
+ * Measures an operation and prints the result.
+ *
+ * The operation is repeated, doubling the amount of iterations, until it
+ * took at least the minimal duration.
+ */
+template <class Bus, class Operation>
+void measure(const char *driver, const char *operation, const char *size,
+             std::size_t pixels_per_op, Bus &bus, Operation &&run) {
+    // warm up the buffers and caches
+    run();
+
+    std::size_t iterations = 1;
+    for (;;) {
+        const std::size_t bytes = bus.bytes_written;
+        const std::size_t started = transactions(bus);
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            run();
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        if (duration < minimal_duration) {
+            iterations *= 2;
+            continue;
+        }
+
+        const double ns_per_op =
+            double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       duration)
+                       .count()) /
+            iterations;
+
+        std::printf("{\"driver\": \"%s\", \"operation\": \"%s\", "
+                    "\"size\": \"%s\", \"iterations\": %zu, "
+                    "\"ns_per_op\": %.1f, \"pixels_per_s\": %.0f, "
+                    "\"bus_bytes_per_op\": %.1f, "
+                    "\"bus_transactions_per_op\": %.1f}\n",
+                    driver, operation, size, iterations, ns_per_op,
+                    pixels_per_op * 1e9 / ns_per_op,
+                    double(bus.bytes_written - bytes) / iterations,
+                    double(transactions(bus) - started) / iterations);
+        return;
+    }
+}
+
+/*
+ * A frame of a driver that shows what is drawn without anything else.
+ */
+struct draw_only_s {
+    template <class Operation>
+    void operator()(Operation &&run) {
+        run();
+    }
+};
+
+/*
+ * A frame of a driver that only sends what has been drawn on a flush, every
+ * operation is drawn in a frame of its own so the time and the bus traffic of
+ * sending it are measured.
+ */
+template <class Display>
+struct flushed_frame_s {
+    Display &display;
+
+    template <class Operation>
+    void operator()(Operation &&run) {
+        display.clear();
+        run();
+        display.flush();
+    }
+};
+
+/*
+ * Runs all operations on a display, every operation is drawn through frame.
+ */
+template <class DisplayScreen, class Display, class Bus,
+          class Frame = draw_only_s>
+void run_all(const char *driver, Display &display, Bus &bus,
+             Frame frame = {}) {
+    constexpr uint16_t width = DisplayScreen::width;
+    constexpr uint16_t height = DisplayScreen::height;
+
+    auto measure_frame = [&](const char *operation, const char *size,
+                             std::size_t pixels_per_op, auto &&run) {
+        measure(driver, operation, size, pixels_per_op, bus,
+                [&] { frame(run); });
+    };
+
+    const uint16_t color = display.color_to_pixel(hwlib::white);
+    uint16_t toggle = 0;
+
+    // fills of different sizes
+    const struct {
+        const char *size;
+        uint16_t width;
+        uint16_t height;
+    } fills[] = {{"1x1", 1, 1},
+                 {"8x8", 8, 8},
+                 {"32x32", 32, 32},
+                 {"full_width_row", width, 1},
+                 {"screen", width, height}};
+
+    for (const auto &fill : fills) {
+        measure_frame("fill", fill.size, fill.width * fill.height, [&] {
+            display.set_pixels(0, 0, fill.width, fill.height,
+                               uint16_t(color ^ toggle++));
+        });
+    }
+
+    uint16_t pixels[32 * 32];
+    for (std::size_t i = 0; i < 32 * 32; i++) {
+        pixels[i] = uint16_t(i * 31);
+    }
+
+    measure_frame("pixels", "32x32", 32 * 32,
+                  [&] { display.set_pixels(1, 1, 32, 32, pixels); });
+
+    measure_frame("glyph", "8x8", 8 * 8,
+                  [&] { display.set_character(8, 8, 'A', color); });
+
+    measure_frame("string", "12_chars", 12 * 8 * 8, [&] {
+        display.set_character(0, 16, "Hello world!", color);
+    });
+
+    display.set_transparent_background(true);
+    measure_frame("string_transparent", "12_chars", 12 * 8 * 8, [&] {
+        display.set_character(0, 16, "Hello world!", color);
+    });
+    display.set_transparent_background(false);
+
+    const struct {
+        const char *size;
+        uint16_t radius;
+    } circles[] = {{"r4", 4}, {"r16", 16}, {"r30", 30}};
+
+    for (const auto &circle : circles) {
+        const std::size_t diameter = (2 * circle.radius) + 1;
+
+        measure_frame("circle_filled", circle.size, diameter * diameter, [&] {
+            display.set_pixels_circle(width / 2, height / 2, circle.radius,
+                                      true, color);
+        });
+
+        measure_frame("circle_outline", circle.size, diameter * diameter,
+                      [&] {
+                          display.set_pixels_circle(width / 2, height / 2,
+                                                    circle.radius, false,
+                                                    color);
+                      });
+    }
+
+    measure_frame("hwlib_write", "1x1", 1, [&] {
+        display.write(hwlib::xy(toggle++ % width, 3), hwlib::white);
+    });
+
+    measure_frame("clear", "screen", width * height,
+                  [&] { display.clear(); });
+
+    // a flush after a small change and after a change of the whole screen
+    measure_frame("flush", "8x8", 8 * 8, [&] {
+        display.set_pixels(16, 16, 8, 8, uint16_t(color ^ toggle++));
+        display.flush();
+    });
+
+    measure_frame("flush", "screen", width * height, [&] {
+        display.set_pixels(0, 0, width, height, uint16_t(color ^ toggle++));
+        display.flush();
+    });
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        minimal_duration = std::chrono::milliseconds(std::atoi(argv[1]));
+    }
+
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    {
+        r2d2::display::mock_spi_bus_c bus;
+        r2d2::display::st7735_buffered_c<r2d2::display::st7735_128x160_s>
+            display(bus, bus.cs, pin_dummy, pin_dummy);
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "st7735_buffered_c<128x160>", display, bus);
+    }
+
+    {
+        r2d2::display::mock_spi_bus_c bus;
+        r2d2::display::st7735_unbuffered_c<r2d2::display::st7735_128x160_s>
+            display(bus, bus.cs, pin_dummy, pin_dummy);
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "st7735_unbuffered_c<128x160>", display, bus);
+    }
+
+    {
+        r2d2::display::mock_spi_bus_c bus;
+        // the pool holds the largest block of pixels of the benchmark
+        r2d2::display::st7735_band_buffered_c<r2d2::display::st7735_128x160_s,
+                                              16, 96, 32 * 32>
+            display(bus, bus.cs, pin_dummy, pin_dummy);
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "st7735_band_buffered_c<128x160, 16, 96, 1024>", display, bus,
+            flushed_frame_s<decltype(display)>{display});
+
+        // operations that didn't fit are not drawn, so they would make the
+        // results above look cheaper than they are
+        std::printf("{\"driver\": "
+                    "\"st7735_band_buffered_c<128x160, 16, 96, 1024>\", "
+                    "\"overflows\": %zu}\n",
+                    display.get_overflows());
+    }
+
+    {
+        r2d2::display::mock_spi_bus_c bus;
+        r2d2::display::st7735_rgb332_buffered_c<r2d2::display::st7735_128x160_s>
+            display(bus, bus.cs, pin_dummy, pin_dummy);
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "st7735_rgb332_buffered_c<128x160>", display, bus);
+    }
+
+    {
+        r2d2::display::mock_spi_bus_c bus;
+        r2d2::display::st7735_indexed_buffered_c<
+            r2d2::display::st7735_128x160_s, 4>
+            display(bus, bus.cs, pin_dummy, pin_dummy);
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "st7735_indexed_buffered_c<128x160, 4>", display, bus);
+    }
+
+    {
+        r2d2::i2c::i2c_bus_c bus;
+        r2d2::display::ssd1306_oled_buffered_c<
+            r2d2::display::ssd1306_128x64_s>
+            display(bus, 0x3C);
+
+        run_all<r2d2::display::ssd1306_128x64_s>(
+            "ssd1306_oled_buffered_c<128x64>", display, bus);
+    }
+
+    {
+        r2d2::i2c::i2c_bus_c bus;
+        r2d2::display::ssd1306_oled_unbuffered_c<
+            r2d2::display::ssd1306_128x64_s>
+            display(bus, 0x3C);
+
+        run_all<r2d2::display::ssd1306_128x64_s>(
+            "ssd1306_oled_unbuffered_c<128x64>", display, bus);
+    }
+
+    {
+        no_bus_s bus;
+        r2d2::display::display_dummy_c<r2d2::display::st7735_128x160_s>
+            display;
+
+        run_all<r2d2::display::st7735_128x160_s>(
+            "display_dummy_c<128x160>", display, bus);
+    }
+
+    return 0;
+}
@@ -1,10 +1,25 @@
 #pragma once
 
 #include <display_cursor.hpp>
+#include <display_glyph.hpp>
 #include <display_screen.hpp>
 #include <hwlib.hpp>
 
 namespace r2d2::display {
+    /**
+     * The visible part of a rectangle after clipping.
+     */
+    struct clipped_rectangle_s {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+
+        // index of the first visible pixel in the pixel data of the
+        // unclipped rectangle
+        std::size_t offset;
+    };
+
     /**
      * Class display_c is the base class for all displays in R2D2. It inherits
      * from hwlib::window.
@@ -24,21 +39,397 @@ namespace r2d2::display {
          * @param col
          */
         void write_implementation(hwlib::xy pos, hwlib::color col) {
+            // hwlib draws single pixels, so this is the only place where a
+            // pixel is checked on its own
+            if (pos.x < clip_x_min || pos.x >= clip_x_max ||
+                pos.y < clip_y_min || pos.y >= clip_y_max) {
+                return;
+            }
+
             set_pixel(pos.x, pos.y, color_to_pixel(col));
         }
 
-        // The font used in the display is 8*8
-        hwlib::font_default_8x8 display_font = hwlib::font_default_8x8();
-
         // Keeps track of cursors
         r2d2::display::display_cursor_s cursors[static_cast<std::size_t>(r2d2::claimed_display_cursor::CURSORS_COUNT)];
 
+        // When true, characters only draw their own pixels and leave the
+        // background untouched
+        bool transparent_background = false;
+
+        // The area that can be drawn on, the maximum values are exclusive
+        int clip_x_min = 0;
+        int clip_y_min = 0;
+        int clip_x_max = DisplayScreen::width;
+        int clip_y_max = DisplayScreen::height;
+
+        /**
+         * @brief Clips a rectangle against the screen and the clip
+         * rectangle. Drawing functions clip once, so their inner loops don't
+         * need to check every pixel.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param result The visible part of the rectangle
+         * @return false when nothing of the rectangle is visible
+         */
+        bool clip_rectangle(int x, int y, int width, int height,
+                            clipped_rectangle_s &result) const {
+            const int stride = width;
+            int offset = 0;
+
+            if (x < clip_x_min) {
+                offset += clip_x_min - x;
+                width -= clip_x_min - x;
+                x = clip_x_min;
+            }
+            if (y < clip_y_min) {
+                offset += (clip_y_min - y) * stride;
+                height -= clip_y_min - y;
+                y = clip_y_min;
+            }
+            if (x + width > clip_x_max) {
+                width = clip_x_max - x;
+            }
+            if (y + height > clip_y_max) {
+                height = clip_y_max - y;
+            }
+
+            if (width <= 0 || height <= 0) {
+                return false;
+            }
+
+            result = {static_cast<uint16_t>(x), static_cast<uint16_t>(y),
+                      static_cast<uint16_t>(width),
+                      static_cast<uint16_t>(height),
+                      static_cast<std::size_t>(offset)};
+            return true;
+        }
+
+        /**
+         * @brief Draws a horizontal span of a circle on the row above and
+         * below the midpoint
+         *
+         * @tparam Self The type of the display the span is drawn on
+         * @param x x-coordinate of the midpoint of the circle
+         * @param y y-coordinate of the midpoint of the circle
+         * @param dy distance of the rows to the midpoint
+         * @param dx_min first pixel of the span relative to the midpoint
+         * @param dx_max last pixel of the span relative to the midpoint
+         * @param data
+         */
+        template <class Self>
+        void draw_circle_spans(int x, int y, int dy, int dx_min, int dx_max,
+                               const uint16_t data) {
+            Self &self = static_cast<Self &>(*this);
+            const int width = dx_max - dx_min + 1;
+            clipped_rectangle_s span;
+
+            if (clip_rectangle(x + dx_min, y + dy, width, 1, span)) {
+                self.set_pixels(span.x, span.y, span.width, 1, data);
+            }
+            if (dy != 0 && clip_rectangle(x + dx_min, y - dy, width, 1, span)) {
+                self.set_pixels(span.x, span.y, span.width, 1, data);
+            }
+        }
+
+        /*
+         * The default implementations of the drawing functions. They call
+         * the primitives they are built on through the type Self. The
+         * virtual functions of display_c use them with Self = display_c.
+         * static_display_c uses them with its own type, which is final, so
+         * every primitive is called directly.
+         */
+
+        /**
+         * @brief Writes multiple pixels a pixel at a time
+         *
+         * @tparam Self The type of the display the pixels are drawn on
+         */
+        template <class Self>
+        void draw_pixels(uint16_t x, uint16_t y, uint16_t width,
+                         uint16_t height, const uint16_t *data) {
+            Self &self = static_cast<Self &>(*this);
+            clipped_rectangle_s rect;
+            if (!clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            data += rect.offset;
+
+            // set the data to the correct pixel
+            for (std::size_t t_y = 0; t_y < rect.height; t_y++) {
+                for (std::size_t t_x = 0; t_x < rect.width; t_x++) {
+                    // set the pixel with data at location of t_x + t_y * width
+                    self.set_pixel(rect.x + t_x, rect.y + t_y,
+                                   data[t_x + (t_y * width)]);
+                }
+            }
+        }
+
+        /**
+         * @brief Fills multiple pixels a pixel at a time
+         *
+         * @tparam Self The type of the display the pixels are drawn on
+         */
+        template <class Self>
+        void draw_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       const uint16_t data) {
+            Self &self = static_cast<Self &>(*this);
+            clipped_rectangle_s rect;
+            if (!clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            // set all the pixels to data
+            for (std::size_t t_y = 0; t_y < rect.height; t_y++) {
+                for (std::size_t t_x = 0; t_x < rect.width; t_x++) {
+                    // set the pixel with datas
+                    self.set_pixel(rect.x + t_x, rect.y + t_y, data);
+                }
+            }
+        }
+
+        /**
+         * @brief Draws a number of characters one character at a time
+         *
+         * @tparam Self The type of the display the characters are drawn on
+         */
+        template <class Self>
+        void draw_characters(uint16_t x, uint16_t y, const char *characters,
+                             std::size_t count, uint16_t pixel_color) {
+            Self &self = static_cast<Self &>(*this);
+            for (std::size_t index = 0; index < count; index++) {
+                self.set_character(x + (index * 8), y, characters[index],
+                                   pixel_color);
+            }
+        }
+
+        /**
+         * @brief Draws a character with set_pixels
+         *
+         * @tparam Self The type of the display the character is drawn on
+         */
+        template <class Self>
+        void draw_character(uint16_t x, uint16_t y, char character,
+                            uint16_t pixel_color) {
+            Self &self = static_cast<Self &>(*this);
+
+            // skip characters that are completely invisible
+            clipped_rectangle_s visible;
+            if (!clip_rectangle(x, y, 8, 8, visible)) {
+                return;
+            }
+
+            const uint8_t *glyph = default_glyph(character);
+
+            if (transparent_background) {
+                // Only draw the horizontal runs of the character itself
+                for (uint16_t image_y = 0; image_y < 8; image_y++) {
+                    uint8_t row = glyph[image_y];
+                    uint16_t image_x = 0;
+
+                    while (row) {
+                        if (!(row & 0x80)) {
+                            row <<= 1;
+                            image_x++;
+                            continue;
+                        }
+
+                        const uint16_t start = image_x;
+                        while (row & 0x80) {
+                            row <<= 1;
+                            image_x++;
+                        }
+
+                        self.set_pixels(x + start, y + image_y,
+                                        image_x - start, 1, pixel_color);
+                    }
+                }
+
+                return;
+            }
+
+            // Expand all rows of the character and write them at once
+            const uint16_t background_pixel = self.color_to_pixel(background);
+            uint16_t pixels[8 * 8];
+
+            for (uint16_t image_y = 0; image_y < 8; image_y++) {
+                expand_glyph_row(glyph[image_y], pixel_color, background_pixel,
+                                 &pixels[image_y * 8]);
+            }
+
+            self.set_pixels(x, y, 8, 8, pixels);
+        }
+
+        /**
+         * @brief Draws a string at the cursor and moves the cursor
+         *
+         * @tparam Self The type of the display the string is drawn on
+         */
+        template <class Self>
+        void draw_cursor_string(uint8_t cursor_target, const char *characters) {
+            Self &self = static_cast<Self &>(*this);
+            display_cursor_s &cursor = cursors[cursor_target];
+            const std::size_t count =
+                characters_in_row(cursor.cursor_x, characters);
+
+            self.set_characters(cursor.cursor_x, cursor.cursor_y, characters,
+                                count, self.color_to_pixel(cursor.cursor_color));
+
+            // Move the cursor past every character that has been drawn
+            for (std::size_t index = 0; index < count; index++) {
+                // If the cursor is about to go out of bounds, return.
+                if (cursor.cursor_x + 8 < DisplayScreen::width) {
+                    self.set_cursor_position(cursor_target, cursor.cursor_x + 8,
+                                             cursor.cursor_y);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Draws the pixels of a row of a circle, dx_min up to dx_max
+         * on both sides of the midpoint. A filled row is a single span from
+         * -dx_max to dx_max.
+         *
+         * @tparam Self The type of the display the row is drawn on
+         */
+        template <class Self>
+        void draw_circle_row(int x, int y, int dy, int dx_min, int dx_max,
+                             bool filled, const uint16_t data) {
+            if (filled || dx_min == 0) {
+                draw_circle_spans<Self>(x, y, dy, -dx_max, dx_max, data);
+            } else {
+                draw_circle_spans<Self>(x, y, dy, -dx_max, -dx_min, data);
+                draw_circle_spans<Self>(x, y, dy, dx_min, dx_max, data);
+            }
+        }
+
+        /**
+         * @brief Draws a circle as horizontal spans
+         *
+         * The pixels are those of the midpoint circle algorithm that the
+         * drivers have always used. The algorithm walks an octant, every
+         * point is mirrored to the other octants. Points of the same row are
+         * collected into a run and the row is drawn when the walk leaves it,
+         * so every row is drawn once.
+         *
+         * @tparam Self The type of the display the circle is drawn on
+         */
+        template <class Self>
+        void draw_circle(uint16_t x, uint16_t y, uint16_t radius, bool filled,
+                         const uint16_t data) {
+            // skip circles that are completely invisible
+            clipped_rectangle_s visible;
+            if (!clip_rectangle(int(x) - radius, int(y) - radius,
+                                (2 * radius) + 1, (2 * radius) + 1, visible)) {
+                return;
+            }
+
+            int t_x = radius;
+            int t_y = 0;
+            int err = 0;
+            int x_change = 1 - (int(radius) << 1);
+            int y_change = 0;
+
+            // the points on row t_y are t_x_min up to t_x_max from the
+            // midpoint, and the points on row t_x t_y_min up to t_y_max
+            int t_x_min = t_x;
+            int t_x_max = t_x;
+            int t_y_min = t_y;
+            int t_y_max = t_y;
+
+            for (;;) {
+                int next_x = t_x;
+                int next_y = t_y;
+
+                if (filled) {
+                    next_y++;
+                    err += y_change;
+                    y_change += 2;
+                    if (((err << 1) + x_change) > 0) {
+                        next_x--;
+                        err += x_change;
+                        x_change += 2;
+                    }
+                } else {
+                    if (err <= 0) {
+                        next_y++;
+                        err += (2 * next_y) + 1;
+                    }
+                    if (err > 0) {
+                        next_x--;
+                        err -= (2 * next_x) + 1;
+                    }
+                }
+
+                if (next_x < next_y) {
+                    break;
+                }
+
+                if (next_y != t_y) {
+                    draw_circle_row<Self>(x, y, t_y, t_x_min, t_x_max, filled,
+                                          data);
+                    t_x_max = next_x;
+                }
+                t_x_min = next_x;
+
+                if (next_x != t_x) {
+                    draw_circle_row<Self>(x, y, t_x, t_y_min, t_y_max, filled,
+                                          data);
+                    t_y_min = next_y;
+                }
+                t_y_max = next_y;
+
+                t_x = next_x;
+                t_y = next_y;
+            }
+
+            // the last rows of both octants are the same row on the diagonal
+            if (t_x == t_y) {
+                draw_circle_row<Self>(
+                    x, y, t_y, t_y_min < t_x_min ? t_y_min : t_x_min,
+                    t_x_max > t_y_max ? t_x_max : t_y_max, filled, data);
+            } else {
+                draw_circle_row<Self>(x, y, t_y, t_x_min, t_x_max, filled,
+                                      data);
+                draw_circle_row<Self>(x, y, t_x, t_y_min, t_y_max, filled,
+                                      data);
+            }
+        }
+
     public:
         display_c(hwlib::xy size, hwlib::color foreground = hwlib::white,
                   hwlib::color background = hwlib::black)
             : hwlib::window(size, foreground, background) {
         }
 
+        /**
+         * @brief Returns the amount of characters of a string that are drawn
+         * when the string starts at x. Characters are drawn until the
+         * position of the next character would be out of bounds.
+         *
+         * @param x x-coordinate of the first character
+         * @param characters Array of characters
+         */
+        std::size_t characters_in_row(uint16_t x, const char *characters) {
+            std::size_t count = 0;
+            while (characters[count] != '\0') {
+                count++;
+
+                if (x + 8 < DisplayScreen::width) {
+                    x += 8;
+                } else {
+                    break;
+                }
+            }
+
+            return count;
+        }
+
         /**
          * @brief Converts a hwlib::color to the pixel data for the screen with
          * a maximum of two bytes for every pixel
@@ -48,7 +439,8 @@ namespace r2d2::display {
         virtual uint16_t color_to_pixel(hwlib::color col) = 0;
 
         /**
-         * @brief Write a pixel to the screen
+         * @brief Write a pixel to the screen. The pixel is not clipped, the
+         * caller has to make sure it is on the screen.
          *
          * @param x
          * @param y
@@ -67,13 +459,7 @@ namespace r2d2::display {
          */
         virtual void set_pixels(uint16_t x, uint16_t y, uint16_t width,
                                 uint16_t height, const uint16_t *data) {
-            // set the data to the correct pixel
-            for (std::size_t t_y = 0; t_y < width; t_y++) {
-                for (std::size_t t_x = 0; t_x < width; t_x++) {
-                    // set the pixel with data at location of t_x + t_y * width
-                    set_pixel(x + t_x, y + t_y, data[t_x + (t_y * width)]);
-                }
-            }
+            draw_pixels<display_c>(x, y, width, height, data);
         }
 
         /**
@@ -88,13 +474,24 @@ namespace r2d2::display {
          */
         virtual void set_pixels(uint16_t x, uint16_t y, uint16_t width,
                                 uint16_t height, const uint16_t data) {
-            // set all the pixels to data
-            for (std::size_t t_y = 0; t_y < width; t_y++) {
-                for (std::size_t t_x = 0; t_x < width; t_x++) {
-                    // set the pixel with datas
-                    set_pixel(x + t_x, y + t_y, data);
-                }
-            }
+            draw_fill<display_c>(x, y, width, height, data);
+        }
+
+        /**
+         * @brief Draws a number of characters next to each other on a single
+         * row. Drivers that write through an address window can override this
+         * to write multiple characters at once.
+         *
+         * @param x x-coordinate of the first character
+         * @param y y-coordinate of the characters
+         * @param characters Array of characters to draw
+         * @param count Amount of characters to draw
+         * @param pixel_color The color of all characters
+         */
+        virtual void set_characters(uint16_t x, uint16_t y,
+                                    const char *characters, std::size_t count,
+                                    uint16_t pixel_color) {
+            draw_characters<display_c>(x, y, characters, count, pixel_color);
         }
 
         /**
@@ -107,21 +504,7 @@ namespace r2d2::display {
          */
         virtual void set_character(uint16_t x, uint16_t y, char character,
                                    uint16_t pixel_color) {
-            // Loops through all rows of the character
-            const hwlib::image &character_image = display_font[character];
-            for (uint16_t image_y = 0; image_y < 8; image_y++) {
-                for (uint16_t image_x = 0; image_x < 8; image_x++) {
-                    // Check if the pixel needs to be drawn.
-                    // If the pixel color is anything other than white, draw it
-                    hwlib::color character_pixel_color =
-                        character_image[hwlib::xy(image_x, image_y)];
-                    if (character_pixel_color != hwlib::white) {
-                        set_pixel(x + image_x, y + image_y, pixel_color);
-                    } else {
-                        set_pixel(x + image_x, y + image_y, color_to_pixel(background));
-                    }
-                }
-            }
+            draw_character<display_c>(x, y, character, pixel_color);
         }
 
         /**
@@ -135,18 +518,8 @@ namespace r2d2::display {
         virtual void set_character(uint16_t x, uint16_t y,
                                    const char *character,
                                    uint16_t pixel_color) {
-            std::size_t index = 0;
-            while (character[index] != '\0') {
-                set_character(x, y, character[index], pixel_color);
-
-                // If the cursor is about to go out of bounds, return.
-                if (x + 8 < DisplayScreen::width) {
-                    x += 8;
-                } else {
-                    return;
-                }
-                index++;
-            }
+            set_characters(x, y, character, characters_in_row(x, character),
+                           pixel_color);
         }
 
         /**
@@ -158,22 +531,7 @@ namespace r2d2::display {
          */
         virtual void set_character(uint8_t cursor_target,
                                    const char *characters) {
-            display_cursor_s &cursor = cursors[cursor_target];
-            std::size_t index = 0;
-            while (characters[index] != '\0') {
-                set_character(cursor.cursor_x, cursor.cursor_y,
-                              characters[index],
-                              color_to_pixel(cursor.cursor_color));
-
-                // If the cursor is about to go out of bounds, return.
-                if (cursor.cursor_x + 8 < DisplayScreen::width) {
-                    set_cursor_position(cursor_target, cursor.cursor_x + 8,
-                                       cursor.cursor_y);
-                } else {
-                    return;
-                }
-                index++;
-            }
+            draw_cursor_string<display_c>(cursor_target, characters);
         }
 
         /**
@@ -189,55 +547,7 @@ namespace r2d2::display {
          */
         virtual void set_pixels_circle(uint16_t x, uint16_t y, uint16_t radius,
                                        bool filled, const uint16_t data) {
-            int t_x = radius;
-            int t_y = 0;
-            int err = 0;
-
-            if (filled == true) {
-                int xChange = 1 - (radius << 1);
-                int yChange = 0;
-
-                while (t_x >= t_y) {
-                    for (int i = x - t_x; i <= x + t_x; i++) {
-                        set_pixel(i, y + t_y, data);
-                        set_pixel(i, y - t_y, data);
-                    }
-                    for (int i = x - t_y; i <= x + t_y; i++) {
-                        set_pixel(i, y + t_x, data);
-                        set_pixel(i, y - t_x, data);
-                    }
-
-                    t_y++;
-                    err += yChange;
-                    yChange += 2;
-                    if (((err << 1) + xChange) > 0) {
-                        t_x--;
-                        err += xChange;
-                        xChange += 2;
-                    }
-                }
-            } else {
-                while (t_x >= t_y) {
-                    set_pixel(x + t_x, y + t_y, data);
-                    set_pixel(x + t_y, y + t_x, data);
-                    set_pixel(x - t_y, y + t_x, data);
-                    set_pixel(x - t_x, y + t_y, data);
-                    set_pixel(x - t_x, y - t_y, data);
-                    set_pixel(x - t_y, y - t_x, data);
-                    set_pixel(x + t_y, y - t_x, data);
-                    set_pixel(x + t_x, y - t_y, data);
-
-                    if (err <= 0) {
-                        t_y += 1;
-                        err += 2 * t_y + 1;
-                    }
-
-                    if (err > 0) {
-                        t_x -= 1;
-                        err -= 2 * t_x + 1;
-                    }
-                }
-            }
+            draw_circle<display_c>(x, y, radius, filled, data);
         }
 
         /**
@@ -293,6 +603,46 @@ namespace r2d2::display {
             cursors[cursor_target].cursor_color = col;
         };
 
+        /**
+         * @brief Sets if characters are drawn with or without their
+         * background. Without a background only the pixels of the character
+         * itself are written.
+         *
+         * @param transparent
+         */
+        virtual void set_transparent_background(bool transparent) {
+            transparent_background = transparent;
+        }
+
+        /**
+         * @brief Limits all drawing to a rectangle on the screen. Anything
+         * outside of it is clipped.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         */
+        virtual void set_clip(uint16_t x, uint16_t y, uint16_t width,
+                              uint16_t height) {
+            clip_x_min = x < DisplayScreen::width ? x : DisplayScreen::width;
+            clip_y_min = y < DisplayScreen::height ? y : DisplayScreen::height;
+            clip_x_max = x + width < DisplayScreen::width
+                             ? x + width
+                             : DisplayScreen::width;
+            clip_y_max = y + height < DisplayScreen::height
+                             ? y + height
+                             : DisplayScreen::height;
+        }
+
+        /**
+         * @brief Allows drawing on the whole screen again
+         *
+         */
+        virtual void reset_clip() {
+            set_clip(0, 0, DisplayScreen::width, DisplayScreen::height);
+        }
+
         /**
          * @brief Override for hwlib::window the class doesn't need to
          * implement a flush if not needed
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace r2d2::display {
+    /**
+     * Interface for a bus that writes data in the background, for example
+     * with DMA. The bus is bound to a single device: it selects the chip or
+     * addresses the device itself.
+     *
+     * Only one write can be in progress at a time. The data has to stay
+     * valid until poll() reports that the write is done.
+     */
+    class async_bus_c {
+    public:
+        virtual ~async_bus_c() = default;
+
+        /**
+         * @brief Starts writing data to the device
+         *
+         * @param data
+         * @param size
+         */
+        virtual void begin_write(const uint8_t *data, std::size_t size) = 0;
+
+        /**
+         * @brief Lets the bus make progress on the current write
+         *
+         * @return true when the last write is done
+         */
+        virtual bool poll() = 0;
+    };
+} // namespace r2d2::display
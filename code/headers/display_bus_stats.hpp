@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace r2d2::display {
+    /**
+     * The traffic a driver generated on its bus.
+     */
+    struct bus_stats_s {
+        // Transactions on the bus, from chip select or i2c start to the end
+        std::size_t transactions = 0;
+
+        // Bytes written, including commands and i2c control bytes
+        std::size_t payload_bytes = 0;
+
+        // Changes of the data/command pin
+        std::size_t dc_toggles = 0;
+
+        // Commands that set the address window: CASET and RASET on the
+        // st7735, column_addr and page_addr on the ssd1306
+        std::size_t address_window_commands = 0;
+
+        // Flushes of the buffer to the display
+        std::size_t flushes = 0;
+    };
+
+    /**
+     * Counts the bus traffic of a driver. The drivers inherit from it and
+     * report every write.
+     *
+     * When disabled the class is empty and all counting compiles to nothing.
+     * The drivers take the counter as a template parameter that defaults to
+     * no_bus_stats_c, pass bus_stats_c to count the traffic.
+     *
+     * @tparam Enabled
+     */
+    template <bool Enabled>
+    class bus_stats_counter_c {
+    protected:
+        bus_stats_s stats;
+
+        // the last level of the data/command pin, a toggle is counted when
+        // the level changes
+        bool dc_level = false;
+        bool dc_level_known = false;
+
+        /**
+         * @brief Count a transaction on the bus
+         *
+         * @param size amount of bytes written in the transaction
+         */
+        void count_transaction(std::size_t size) {
+            stats.transactions++;
+            stats.payload_bytes += size;
+        }
+
+        /**
+         * @brief Count a write to the data/command pin
+         *
+         * @param level
+         */
+        void count_dc(bool level) {
+            if (dc_level_known && level != dc_level) {
+                stats.dc_toggles++;
+            }
+
+            dc_level = level;
+            dc_level_known = true;
+        }
+
+        /**
+         * @brief Count a command that sets the address window
+         *
+         */
+        void count_address_window_command() {
+            stats.address_window_commands++;
+        }
+
+        /**
+         * @brief Count a flush
+         *
+         */
+        void count_flush() {
+            stats.flushes++;
+        }
+
+    public:
+        constexpr static bool bus_stats_enabled = true;
+
+        /**
+         * @brief Returns a snapshot of the bus traffic since the last reset
+         *
+         * @return bus_stats_s
+         */
+        bus_stats_s get_bus_stats() const {
+            return stats;
+        }
+
+        /**
+         * @brief Sets all counters to 0
+         *
+         */
+        void reset_bus_stats() {
+            stats = bus_stats_s();
+        }
+    };
+
+    template <>
+    class bus_stats_counter_c<false> {
+    protected:
+        void count_transaction(std::size_t) {
+        }
+
+        void count_dc(bool) {
+        }
+
+        void count_address_window_command() {
+        }
+
+        void count_flush() {
+        }
+
+    public:
+        constexpr static bool bus_stats_enabled = false;
+
+        bus_stats_s get_bus_stats() const {
+            return bus_stats_s();
+        }
+
+        void reset_bus_stats() {
+        }
+    };
+
+    using bus_stats_c = bus_stats_counter_c<true>;
+    using no_bus_stats_c = bus_stats_counter_c<false>;
+} // namespace r2d2::display
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace r2d2::display {
+    /**
+     * A rectangle on the screen that has changed since the last flush. All
+     * coordinates are inclusive.
+     */
+    struct dirty_rectangle_s {
+        uint16_t x_min;
+        uint16_t y_min;
+        uint16_t x_max;
+        uint16_t y_max;
+
+        /**
+         * @brief Returns the amount of pixels in the rectangle
+         *
+         * @return uint32_t
+         */
+        constexpr uint32_t area() const {
+            return uint32_t(x_max - x_min + 1) * uint32_t(y_max - y_min + 1);
+        }
+
+        /**
+         * @brief Returns true if the other rectangle lies completely inside
+         * this rectangle
+         *
+         * @param other
+         */
+        constexpr bool contains(const dirty_rectangle_s &other) const {
+            return other.x_min >= x_min && other.x_max <= x_max &&
+                   other.y_min >= y_min && other.y_max <= y_max;
+        }
+
+        /**
+         * @brief Returns the smallest rectangle that contains both rectangles
+         *
+         * @param other
+         */
+        constexpr dirty_rectangle_s unite(const dirty_rectangle_s &other) const {
+            return {x_min < other.x_min ? x_min : other.x_min,
+                    y_min < other.y_min ? y_min : other.y_min,
+                    x_max > other.x_max ? x_max : other.x_max,
+                    y_max > other.y_max ? y_max : other.y_max};
+        }
+    };
+
+    /**
+     * Class dirty_region_c keeps a small list of rectangles that need to be
+     * sent to the screen on the next flush.
+     *
+     * Every rectangle costs a new address window on the bus. Two rectangles
+     * are merged when sending the pixels of their bounding box is cheaper
+     * than sending both rectangles with their own window. When the list is
+     * full the new rectangle is merged with the rectangle that adds the least
+     * amount of extra pixels.
+     *
+     * @tparam MaxRectangles the maximum amount of rectangles to keep track of
+     * @tparam WindowCost the overhead of setting a new address window,
+     * expressed in pixels
+     */
+    template <std::size_t MaxRectangles, uint32_t WindowCost>
+    class dirty_region_c {
+    protected:
+        dirty_rectangle_s rectangles[MaxRectangles] = {};
+        std::size_t count = 0;
+
+        /**
+         * @brief Remove the rectangle at the index by moving the last
+         * rectangle in its place
+         *
+         * @param index
+         */
+        void remove(std::size_t index) {
+            rectangles[index] = rectangles[count - 1];
+            count--;
+        }
+
+        /**
+         * @brief Returns the amount of extra pixels that need to be sent when
+         * the two rectangles are merged
+         *
+         * @param a
+         * @param b
+         */
+        static uint32_t merge_penalty(const dirty_rectangle_s &a,
+                                      const dirty_rectangle_s &b) {
+            const uint32_t merged = a.unite(b).area();
+            const uint32_t separate = a.area() + b.area();
+
+            return merged > separate ? merged - separate : 0;
+        }
+
+    public:
+        /**
+         * @brief Mark a rectangle as dirty
+         *
+         * @param x_min
+         * @param y_min
+         * @param x_max
+         * @param y_max
+         */
+        void add(uint16_t x_min, uint16_t y_min, uint16_t x_max,
+                 uint16_t y_max) {
+            dirty_rectangle_s rect = {x_min, y_min, x_max, y_max};
+
+            // most draw calls land inside a rectangle that is already dirty
+            for (std::size_t i = count; i > 0; i--) {
+                if (rectangles[i - 1].contains(rect)) {
+                    return;
+                }
+            }
+
+            // merge with every rectangle where a single window is cheaper
+            for (std::size_t i = 0; i < count;) {
+                if (merge_penalty(rectangles[i], rect) <= WindowCost) {
+                    rect = rectangles[i].unite(rect);
+                    remove(i);
+
+                    // the bigger rectangle might now merge with earlier ones
+                    i = 0;
+                } else {
+                    i++;
+                }
+            }
+
+            if (count == MaxRectangles) {
+                // no room left, merge with the cheapest rectangle
+                std::size_t cheapest = 0;
+                for (std::size_t i = 1; i < count; i++) {
+                    if (merge_penalty(rectangles[i], rect) <
+                        merge_penalty(rectangles[cheapest], rect)) {
+                        cheapest = i;
+                    }
+                }
+
+                rect = rectangles[cheapest].unite(rect);
+                remove(cheapest);
+            }
+
+            rectangles[count++] = rect;
+        }
+
+        /**
+         * @brief Calls send for the part of every rectangle between two rows
+         * and forgets it. The parts above and below the rows stay dirty.
+         *
+         * @param y_min
+         * @param y_max
+         * @param send
+         */
+        template <class Send>
+        void take(uint16_t y_min, uint16_t y_max, Send &&send) {
+            // every rectangle can leave a part above and below the rows
+            dirty_rectangle_s outside[MaxRectangles * 2];
+            std::size_t outside_count = 0;
+
+            for (std::size_t i = 0; i < count; i++) {
+                const dirty_rectangle_s &rect = rectangles[i];
+                dirty_rectangle_s inside = rect;
+
+                if (inside.y_min < y_min) {
+                    outside[outside_count++] = {
+                        rect.x_min, rect.y_min, rect.x_max,
+                        rect.y_max < y_min ? rect.y_max : uint16_t(y_min - 1)};
+                    inside.y_min = y_min;
+                }
+                if (inside.y_max > y_max) {
+                    outside[outside_count++] = {
+                        rect.x_min,
+                        rect.y_min > y_max ? rect.y_min : uint16_t(y_max + 1),
+                        rect.x_max, rect.y_max};
+                    inside.y_max = y_max;
+                }
+
+                if (inside.y_min <= inside.y_max) {
+                    send(inside);
+                }
+            }
+
+            count = 0;
+
+            for (std::size_t i = 0; i < outside_count; i++) {
+                add(outside[i].x_min, outside[i].y_min, outside[i].x_max,
+                    outside[i].y_max);
+            }
+        }
+
+        /**
+         * @brief Forget all dirty rectangles
+         *
+         */
+        void clear() {
+            count = 0;
+        }
+
+        /**
+         * @brief Returns true if nothing needs to be sent
+         *
+         */
+        bool empty() const {
+            return count == 0;
+        }
+
+        /**
+         * @brief Returns the amount of dirty rectangles
+         *
+         */
+        std::size_t size() const {
+            return count;
+        }
+
+        const dirty_rectangle_s *begin() const {
+            return rectangles;
+        }
+
+        const dirty_rectangle_s *end() const {
+            return rectangles + count;
+        }
+    };
+} // namespace r2d2::display
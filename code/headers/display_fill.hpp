@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace r2d2::display {
+    /**
+     * @brief Fills a run of 16 bit pixels with the same value. After the
+     * first pixel is aligned two pixels are written with every 32 bit store,
+     * eight pixels per loop.
+     *
+     * @param destination
+     * @param value The pixel as it is stored in the buffer
+     * @param count amount of pixels
+     */
+    inline void buffer_fill(uint16_t *destination, uint16_t value,
+                            std::size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        // align the destination to a word
+        if (reinterpret_cast<uintptr_t>(destination) & 0x02) {
+            *destination++ = value;
+            count--;
+        }
+
+        const uint32_t pair = (uint32_t(value) << 16) | value;
+
+        // memcpy compiles to a single store
+        for (; count >= 8; count -= 8, destination += 8) {
+            std::memcpy(destination, &pair, sizeof(pair));
+            std::memcpy(destination + 2, &pair, sizeof(pair));
+            std::memcpy(destination + 4, &pair, sizeof(pair));
+            std::memcpy(destination + 6, &pair, sizeof(pair));
+        }
+
+        for (; count >= 2; count -= 2, destination += 2) {
+            std::memcpy(destination, &pair, sizeof(pair));
+        }
+
+        if (count) {
+            *destination = value;
+        }
+    }
+
+    /**
+     * @brief Fills a rectangle of a buffer with 16 bit pixels. A rectangle
+     * as wide as the buffer is filled as a single run.
+     *
+     * @param buffer
+     * @param stride The width of the buffer in pixels
+     * @param x
+     * @param y
+     * @param width
+     * @param height
+     * @param value The pixel as it is stored in the buffer
+     */
+    inline void buffer_fill_rectangle(uint16_t *buffer, std::size_t stride,
+                                      uint16_t x, uint16_t y, uint16_t width,
+                                      uint16_t height, uint16_t value) {
+        uint16_t *row = buffer + x + (y * stride);
+
+        if (width == stride) {
+            buffer_fill(row, value, std::size_t(width) * height);
+            return;
+        }
+
+        for (uint16_t current_height = 0; current_height < height;
+             current_height++, row += stride) {
+            buffer_fill(row, value, width);
+        }
+    }
+
+    /**
+     * @brief Fills a rectangle of a buffer with pixels of a single bit. Every
+     * byte of the buffer is a column of 8 pixels of a page, like the ssd1306
+     * uses. Pages that are completely covered are written a byte at a
+     * time, rows of full pages that are as wide as the buffer as a single
+     * run.
+     *
+     * @param buffer
+     * @param stride The width of the buffer in pixels
+     * @param x
+     * @param y
+     * @param width
+     * @param height
+     * @param on Sets the pixels when true, clears them otherwise
+     */
+    inline void mono_buffer_fill_rectangle(uint8_t *buffer, std::size_t stride,
+                                           uint16_t x, uint16_t y,
+                                           uint16_t width, uint16_t height,
+                                           bool on) {
+        const uint8_t fill = on ? 0xFF : 0x00;
+        const uint16_t y_end = y + height;
+
+        while (y < y_end) {
+            const uint16_t page = y / 8;
+            const uint16_t page_end =
+                (page + 1) * 8 < y_end ? (page + 1) * 8 : y_end;
+
+            // the bits of the page that are in the rectangle
+            const uint8_t mask =
+                (0xFF << (y % 8)) & (0xFF >> (((page + 1) * 8) - page_end));
+            uint8_t *column = buffer + x + (page * stride);
+
+            if (mask == 0xFF) {
+                // combine all following full pages into one run when the
+                // rectangle is as wide as the buffer
+                uint16_t pages = 1;
+                if (width == stride) {
+                    pages = (y_end - y) / 8;
+                }
+
+                std::memset(column, fill, std::size_t(width) * pages);
+                y += pages * 8;
+                continue;
+            }
+
+            for (uint16_t current_width = 0; current_width < width;
+                 current_width++) {
+                column[current_width] =
+                    on ? column[current_width] | mask
+                       : column[current_width] & ~mask;
+            }
+
+            y = page_end;
+        }
+    }
+} // namespace r2d2::display
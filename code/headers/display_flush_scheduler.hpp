@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * Interface for the time source of a flush scheduler, so the schedulers
+     * can be tested with a clock that is controlled by the test.
+     */
+    class display_clock_c {
+    public:
+        virtual ~display_clock_c() = default;
+
+        /**
+         * @brief Returns the current time in microseconds
+         *
+         * @return uint_fast64_t
+         */
+        virtual uint_fast64_t now_us() = 0;
+    };
+
+    /**
+     * Clock that uses the time of hwlib.
+     */
+    class hwlib_clock_c : public display_clock_c {
+    public:
+        uint_fast64_t now_us() override {
+            return hwlib::now_us();
+        }
+    };
+
+    /**
+     * @brief Returns the clock that is used when no clock is given
+     *
+     * @return display_clock_c&
+     */
+    inline display_clock_c &default_display_clock() {
+        static hwlib_clock_c clock;
+        return clock;
+    }
+
+    /**
+     * Interface for the classes that decide when a display module flushes
+     * the drawn frames to the display.
+     */
+    class flush_scheduler_c {
+    public:
+        virtual ~flush_scheduler_c() = default;
+
+        /**
+         * @brief Called after a frame has been drawn
+         *
+         * @return true when the display should be flushed now
+         */
+        virtual bool frame_drawn() = 0;
+
+        /**
+         * @brief Called when there are no more frames to draw
+         *
+         * @return true when the display should be flushed now
+         */
+        virtual bool idle() = 0;
+
+        /**
+         * @brief Called after the display has been flushed
+         *
+         */
+        virtual void flushed() = 0;
+    };
+
+    /**
+     * Flushes once all available frames have been drawn, or earlier when too
+     * many frames have been drawn or the oldest frame has waited too long.
+     */
+    class coalescing_flush_scheduler_c : public flush_scheduler_c {
+    protected:
+        display_clock_c &clock;
+
+        // The maximum amount of drawn frames before the display is flushed
+        std::size_t max_frames_per_flush;
+
+        // The maximum time in microseconds between drawing a frame and
+        // flushing it to the display
+        uint_fast64_t max_flush_delay_us;
+
+        // The amount of frames drawn since the last flush
+        std::size_t pending_frames = 0;
+
+        // The time the first frame since the last flush was drawn
+        uint_fast64_t first_pending_us = 0;
+
+    public:
+        /**
+         * @param max_frames_per_flush
+         * @param max_flush_delay_us
+         * @param clock
+         */
+        coalescing_flush_scheduler_c(
+            std::size_t max_frames_per_flush = 32,
+            uint_fast64_t max_flush_delay_us = 50'000,
+            display_clock_c &clock = default_display_clock())
+            : clock(clock),
+              max_frames_per_flush(max_frames_per_flush),
+              max_flush_delay_us(max_flush_delay_us) {
+        }
+
+        bool frame_drawn() override {
+            const uint_fast64_t now = clock.now_us();
+
+            if (pending_frames == 0) {
+                first_pending_us = now;
+            }
+            pending_frames++;
+
+            return pending_frames >= max_frames_per_flush ||
+                   now - first_pending_us >= max_flush_delay_us;
+        }
+
+        bool idle() override {
+            return pending_frames > 0;
+        }
+
+        void flushed() override {
+            pending_frames = 0;
+        }
+    };
+
+    /**
+     * Flushes at most once every frame period. Frames are drawn as soon as
+     * they arrive, but the display is only flushed when the deadline of the
+     * next frame has passed.
+     */
+    class frame_rate_flush_scheduler_c : public flush_scheduler_c {
+    protected:
+        display_clock_c &clock;
+
+        // The time between two flushes
+        uint_fast64_t frame_period_us;
+
+        // The earliest time of the next flush
+        uint_fast64_t next_flush_us = 0;
+
+        // True when frames have been drawn since the last flush
+        bool pending = false;
+
+        /**
+         * @brief Returns true if there is something to flush and the
+         * deadline has passed
+         *
+         */
+        bool due() {
+            return pending && clock.now_us() >= next_flush_us;
+        }
+
+    public:
+        /**
+         * @param frames_per_second The maximum amount of flushes per
+         * second, 0 flushes every frame without a cap
+         * @param clock
+         */
+        frame_rate_flush_scheduler_c(
+            uint_fast64_t frames_per_second,
+            display_clock_c &clock = default_display_clock())
+            : clock(clock),
+              frame_period_us(frames_per_second == 0
+                                  ? 0
+                                  : 1'000'000 / frames_per_second) {
+        }
+
+        bool frame_drawn() override {
+            pending = true;
+            return due();
+        }
+
+        bool idle() override {
+            return due();
+        }
+
+        void flushed() override {
+            const uint_fast64_t now = clock.now_us();
+            pending = false;
+
+            // keep the rhythm, unless the display has been idle for more
+            // than a frame
+            if (now >= next_flush_us + frame_period_us) {
+                next_flush_us = now + frame_period_us;
+            } else {
+                next_flush_us += frame_period_us;
+            }
+        }
+    };
+} // namespace r2d2::display
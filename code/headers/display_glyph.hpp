@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * Bit packed 8x8 glyphs for the first 128 ascii characters. Every glyph
+     * is 8 rows of one byte, bit 7 of a row is the leftmost pixel. A set bit
+     * is a pixel of the character, a cleared bit is background.
+     */
+    struct glyph_table_s {
+        uint8_t rows[128][8];
+    };
+
+    // The table is built in RAM once, because hwlib::font only gives access
+    // to the pixels through hwlib::image. That costs a single kilobyte,
+    // shared by all displays.
+    static_assert(sizeof(glyph_table_s) == 1024,
+                  "The glyph table should take 1 KB of RAM");
+
+    /**
+     * Masks for 4 pixels for every possible nibble of a glyph row. Mask 0 is
+     * the leftmost pixel (bit 3 of the nibble).
+     */
+    struct glyph_nibble_masks_s {
+        uint16_t masks[16][4];
+    };
+
+    /**
+     * @brief Generates the nibble masks at compile time
+     *
+     * @return constexpr glyph_nibble_masks_s
+     */
+    constexpr glyph_nibble_masks_s make_glyph_nibble_masks() {
+        glyph_nibble_masks_s result = {};
+
+        for (uint8_t nibble = 0; nibble < 16; nibble++) {
+            for (uint8_t bit = 0; bit < 4; bit++) {
+                result.masks[nibble][bit] =
+                    (nibble & (0x08 >> bit)) ? 0xFFFF : 0x0000;
+            }
+        }
+
+        return result;
+    }
+
+    constexpr glyph_nibble_masks_s glyph_nibble_masks =
+        make_glyph_nibble_masks();
+
+    /**
+     * @brief Packs every glyph of a hwlib font into a glyph table. Any pixel
+     * that is not white in the font is part of the character.
+     *
+     * @param font
+     * @return glyph_table_s
+     */
+    inline glyph_table_s make_glyph_table(const hwlib::font &font) {
+        glyph_table_s table = {};
+
+        for (uint8_t character = 0; character < 128; character++) {
+            const hwlib::image &image = font[static_cast<char>(character)];
+
+            for (uint8_t y = 0; y < 8; y++) {
+                for (uint8_t x = 0; x < 8; x++) {
+                    if (image[hwlib::xy(x, y)] != hwlib::white) {
+                        table.rows[character][y] |= 0x80 >> x;
+                    }
+                }
+            }
+        }
+
+        return table;
+    }
+
+    /**
+     * @brief Returns the glyph table of hwlib::font_default_8x8. The table
+     * is built on the first call.
+     *
+     * @return const glyph_table_s&
+     */
+    inline const glyph_table_s &default_glyph_table() {
+        static const glyph_table_s table =
+            make_glyph_table(hwlib::font_default_8x8());
+
+        return table;
+    }
+
+    /**
+     * @brief Returns the 8 rows of a character in the default glyph table
+     *
+     * @param character
+     * @return const uint8_t*
+     */
+    inline const uint8_t *default_glyph(char character) {
+        return default_glyph_table().rows[static_cast<uint8_t>(character) &
+                                          0x7F];
+    }
+
+    /**
+     * @brief Expands a single glyph row to 8 pixels
+     *
+     * @param row bit packed row of the glyph
+     * @param foreground pixel data for the bits that are set
+     * @param background pixel data for the bits that are cleared
+     * @param pixels destination of the 8 pixels
+     */
+    inline void expand_glyph_row(uint8_t row, uint16_t foreground,
+                                 uint16_t background, uint16_t *pixels) {
+        const uint16_t *high = glyph_nibble_masks.masks[row >> 4];
+        const uint16_t *low = glyph_nibble_masks.masks[row & 0x0F];
+
+        for (uint8_t i = 0; i < 4; i++) {
+            pixels[i] = (foreground & high[i]) | (background & ~high[i]);
+            pixels[i + 4] = (foreground & low[i]) | (background & ~low[i]);
+        }
+    }
+} // namespace r2d2::display
@@ -3,24 +3,50 @@
 
 #include <base_module.hpp>
 #include <display_adapter.hpp>
+#include <display_flush_scheduler.hpp>
 #include <hwlib.hpp>
 
 namespace r2d2::display {
-    template <class DisplayScreen>
+    /**
+     * The module that draws the frames it receives on a display. The given
+     * scheduler decides when they are flushed, coalescing_module_c owns a
+     * coalescing_flush_scheduler_c.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam Display The type of the display. The default calls the display
+     * through the virtual functions of display_c, a static_display_c makes
+     * the calls direct.
+     */
+    template <class DisplayScreen, class Display = display_c<DisplayScreen>>
     class module_c : public base_module_c {
     protected:
-        display_c<DisplayScreen> &display;
+        Display &display;
+
+        // Decides when the drawn frames are flushed to the display
+        flush_scheduler_c &scheduler;
 
-    public:
         /**
-         * @param comm
-         * @param led
+         * Lets the scheduler know a frame has been drawn and flushes the
+         * display when it is time.
          */
-        module_c(base_comm_c &comm,
-                 display_c<DisplayScreen> &display)
-            : base_module_c(comm), display(display) {
+        void frame_drawn() {
+            if (scheduler.frame_drawn()) {
+                flush();
+            }
+        }
+
+        /**
+         * Flushes all drawn frames to the display.
+         */
+        void flush() {
+            display.flush();
+            scheduler.flushed();
+        }
 
-            // Set up listeners
+        /**
+         * Set up the listeners for the frames the module handles.
+         */
+        void listen_for_frames() {
             comm.listen_for_frames(
                 {r2d2::frame_type::DISPLAY_RECTANGLE,
                  r2d2::frame_type::DISPLAY_8X8_CHARACTER,
@@ -31,8 +57,27 @@ namespace r2d2::display {
                  r2d2::frame_type::CURSOR_COLOR});
         }
 
+    public:
         /**
-         * Let the module process data.
+         * The scheduler decides when the drawn frames are flushed to the
+         * display, for example frame_rate_flush_scheduler_c to limit the
+         * refresh rate.
+         *
+         * @param comm
+         * @param display
+         * @param scheduler
+         */
+        module_c(base_comm_c &comm,
+                 Display &display,
+                 flush_scheduler_c &scheduler)
+            : base_module_c(comm), display(display), scheduler(scheduler) {
+
+            listen_for_frames();
+        }
+
+        /**
+         * Let the module process data. All frames that are available are
+         * drawn, the scheduler decides when they are flushed to the display.
          */
         void process() override {
             while (comm.has_data()) {
@@ -56,7 +101,7 @@ namespace r2d2::display {
                             )
                         );
 
-                        display.flush();
+                        frame_drawn();
 
                     } break;
 
@@ -71,7 +116,7 @@ namespace r2d2::display {
                             )
                         );
 
-                        display.flush();
+                        frame_drawn();
 
                     } break;
 
@@ -80,11 +125,13 @@ namespace r2d2::display {
                             frame_type::DISPLAY_8X8_CHARACTER_VIA_CURSOR
                         >();
                         if (data.cursor_id >= static_cast<const uint8_t>(r2d2::claimed_display_cursor::CURSORS_COUNT)) {
-                            return;
+                            continue;
                         }
 
                         display.set_character(data.cursor_id, data.characters);
 
+                        frame_drawn();
+
                     } break;
 
                     case r2d2::frame_type::DISPLAY_CIRCLE: {
@@ -100,7 +147,7 @@ namespace r2d2::display {
                                 )
                         );
 
-                        display.flush();
+                        frame_drawn();
 
                     } break;
 
@@ -110,14 +157,14 @@ namespace r2d2::display {
                             frame_type::DISPLAY_CIRCLE_VIA_CURSOR
                         >();
                         if (data.cursor_id >= static_cast<const uint8_t>(r2d2::claimed_display_cursor::CURSORS_COUNT)) {
-                            return;
+                            continue;
                         }
 
                         display.set_pixels_circle(
                             data.cursor_id, data.radius, data.filled
                         );
 
-                        display.flush();
+                        frame_drawn();
 
                     } break;
 
@@ -126,7 +173,7 @@ namespace r2d2::display {
                             frame_type::CURSOR_POSITION
                         >();
                         if (data.cursor_id >= static_cast<const uint8_t>(r2d2::claimed_display_cursor::CURSORS_COUNT)) {
-                            return;
+                            continue;
                         }
                         display.set_cursor_position(
                             data.cursor_id, data.cursor_x, data.cursor_y
@@ -139,7 +186,7 @@ namespace r2d2::display {
                             frame_type::CURSOR_COLOR
                         >();
                         if (data.cursor_id >= static_cast<const uint8_t>(r2d2::claimed_display_cursor::CURSORS_COUNT)) {
-                            return;
+                            continue;
                         }
 
                         display.set_cursor_color(data.cursor_id,
@@ -152,6 +199,75 @@ namespace r2d2::display {
                     } break;
                 }
             }
+
+            // Everything that has been received is drawn, this is also
+            // called without new frames so a waiting flush is not missed
+            if (scheduler.idle()) {
+                flush();
+            }
         }
     };
+
+    template <class DisplayScreen>
+    module_c(base_comm_c &comm, display_c<DisplayScreen> &display,
+             flush_scheduler_c &scheduler)
+        -> module_c<DisplayScreen>;
+
+    /**
+     * Owns the scheduler of a coalescing_module_c. It is the first base
+     * class, so the scheduler is constructed before module_c refers to it.
+     */
+    struct owned_flush_scheduler_s {
+        coalescing_flush_scheduler_c owned_scheduler;
+
+        owned_flush_scheduler_s(std::size_t max_frames_per_flush,
+                                uint_fast64_t max_flush_delay_us)
+            : owned_scheduler(max_frames_per_flush, max_flush_delay_us) {
+        }
+    };
+
+    /**
+     * A module_c with its own coalescing_flush_scheduler_c. Frames that are
+     * received together are drawn first and flushed to the display at once.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam Display The type of the display, see module_c
+     */
+    template <class DisplayScreen, class Display = display_c<DisplayScreen>>
+    class coalescing_module_c : private owned_flush_scheduler_s,
+                                public module_c<DisplayScreen, Display> {
+    public:
+        /**
+         * @param comm
+         * @param display
+         * @param max_frames_per_flush Maximum amount of frames that are drawn
+         * before the display is flushed
+         * @param max_flush_delay_us Maximum time in microseconds a drawn frame
+         * waits before the display is flushed
+         */
+        coalescing_module_c(base_comm_c &comm,
+                            Display &display,
+                            std::size_t max_frames_per_flush = 32,
+                            uint_fast64_t max_flush_delay_us = 50'000)
+            : owned_flush_scheduler_s(max_frames_per_flush,
+                                      max_flush_delay_us),
+              module_c<DisplayScreen, Display>(comm, display,
+                                               owned_scheduler) {
+        }
+    };
+
+    template <class DisplayScreen>
+    coalescing_module_c(base_comm_c &comm, display_c<DisplayScreen> &display)
+        -> coalescing_module_c<DisplayScreen>;
+
+    template <class DisplayScreen>
+    coalescing_module_c(base_comm_c &comm, display_c<DisplayScreen> &display,
+                        std::size_t max_frames_per_flush)
+        -> coalescing_module_c<DisplayScreen>;
+
+    template <class DisplayScreen>
+    coalescing_module_c(base_comm_c &comm, display_c<DisplayScreen> &display,
+                        std::size_t max_frames_per_flush,
+                        uint_fast64_t max_flush_delay_us)
+        -> coalescing_module_c<DisplayScreen>;
 } // namespace r2d2::display
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * @brief Swaps the bytes of a pixel. The screen expects the most
+     * significant byte first, the processor stores the least significant byte
+     * first. Compiles to a single REV16 instruction on the arduino due.
+     *
+     * @param data
+     * @return constexpr uint16_t
+     */
+    constexpr uint16_t swap_bytes(uint16_t data) {
+        return static_cast<uint16_t>((data << 8) | (data >> 8));
+    }
+
+    /**
+     * @brief Swaps the bytes of multiple pixels, two pixels at a time
+     *
+     * @param source
+     * @param destination
+     * @param count amount of pixels
+     */
+    inline void swap_bytes(const uint16_t *source, uint16_t *destination,
+                           std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            // memcpy compiles to a single load and store
+            uint32_t pair;
+            std::memcpy(&pair, source + i, sizeof(pair));
+            pair = ((pair & 0x00FF00FF) << 8) | ((pair >> 8) & 0x00FF00FF);
+            std::memcpy(destination + i, &pair, sizeof(pair));
+        }
+
+        if (i < count) {
+            destination[i] = swap_bytes(source[i]);
+        }
+    }
+
+    /**
+     * @brief Converts a hwlib::color to RGB565. The components are scaled
+     * the same way as c * 0x1F / 0xFF and c * 0x3F / 0xFF, rounded down,
+     * but with a multiplication and a shift instead of a division. The
+     * results are equal for every value of c from 0 to 255.
+     *
+     * @param col
+     * @return constexpr uint16_t
+     */
+    constexpr uint16_t color_to_rgb565(hwlib::color col) {
+        return static_cast<uint16_t>(((uint32_t(col.red) * 249) >> 11) << 11 |
+                                     ((uint32_t(col.green) * 253) >> 10) << 5 |
+                                     ((uint32_t(col.blue) * 249) >> 11));
+    }
+
+    /**
+     * @brief Converts a hwlib::color to RGB332, 3 bits red, 3 bits green and
+     * 2 bits blue
+     *
+     * @param col
+     * @return constexpr uint8_t
+     */
+    constexpr uint8_t color_to_rgb332(hwlib::color col) {
+        return static_cast<uint8_t>((col.red & 0xE0) |
+                                    ((col.green & 0xE0) >> 3) |
+                                    (col.blue >> 6));
+    }
+
+    /**
+     * @brief Converts a RGB332 pixel to RGB565. The bits of every component
+     * are repeated, so black stays black and white stays white.
+     *
+     * @param pixel
+     * @return constexpr uint16_t
+     */
+    constexpr uint16_t rgb332_to_rgb565(uint8_t pixel) {
+        const uint16_t red = pixel >> 5;
+        const uint16_t green = (pixel >> 2) & 0x07;
+        const uint16_t blue = pixel & 0x03;
+
+        return static_cast<uint16_t>(
+            (((red << 2) | (red >> 1)) << 11) | (((green << 3) | green) << 5) |
+            ((blue << 3) | (blue << 1) | (blue >> 1)));
+    }
+
+    /**
+     * RGB565 pixels that are stored in the byte order of the screen. Every
+     * pixel is swapped when it is drawn, the buffer is sent as it is.
+     */
+    struct rgb565_big_endian_s {
+        // true when the buffer holds pixels in the byte order of the processor
+        constexpr static bool native_order = false;
+
+        constexpr static uint16_t from_color(hwlib::color col) {
+            return color_to_rgb565(col);
+        }
+
+        constexpr static uint16_t to_storage(uint16_t pixel) {
+            return swap_bytes(pixel);
+        }
+    };
+
+    /**
+     * RGB565 pixels that are stored in the byte order of the processor. The
+     * pixels are swapped in bulk when the buffer is flushed.
+     */
+    struct rgb565_native_s {
+        // true when the buffer holds pixels in the byte order of the processor
+        constexpr static bool native_order = true;
+
+        constexpr static uint16_t from_color(hwlib::color col) {
+            return color_to_rgb565(col);
+        }
+
+        constexpr static uint16_t to_storage(uint16_t pixel) {
+            return pixel;
+        }
+    };
+
+    /**
+     * Pixels of a single bit, only white is on.
+     */
+    struct mono_1bpp_s {
+        // true when the buffer holds pixels in the byte order of the processor
+        constexpr static bool native_order = true;
+
+        constexpr static uint16_t from_color(hwlib::color col) {
+            return col == hwlib::white;
+        }
+
+        constexpr static uint16_t to_storage(uint16_t pixel) {
+            return pixel != 0;
+        }
+    };
+} // namespace r2d2::display
@@ -8,6 +8,8 @@ namespace r2d2::display {
         constexpr static uint8_t height = 160;
         constexpr static uint8_t x_offset = 0;
         constexpr static uint8_t y_offset = 0;
+        // amount of rows in the memory of the st7735 on this screen
+        constexpr static uint16_t memory_height = 162;
     };
 
     struct st7735_80x160_s {
@@ -15,6 +17,8 @@ namespace r2d2::display {
         constexpr static uint8_t height = 160;
         constexpr static uint8_t x_offset = 26;
         constexpr static uint8_t y_offset = 1;
+        // amount of rows in the memory of the st7735 on this screen
+        constexpr static uint16_t memory_height = 162;
     };
 
     struct ssd1306_128x64_s {
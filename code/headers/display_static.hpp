@@ -0,0 +1,198 @@
+#pragma once
+
+#include <display_adapter.hpp>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * @brief True for the display_c base class itself, used to find out if a
+     * driver implements a function or uses the default of display_c
+     *
+     * @tparam T
+     */
+    template <class T>
+    struct is_display_base_s {
+        constexpr static bool value = false;
+    };
+
+    template <class DisplayScreen>
+    struct is_display_base_s<display_c<DisplayScreen>> {
+        constexpr static bool value = true;
+    };
+
+    /**
+     * @brief Returns true when a member function belongs to display_c
+     * itself, so the driver uses the default implementation
+     *
+     * Usage:
+     * uses_display_default<void(uint16_t, uint16_t, char, uint16_t)>(
+     *     &Driver::set_character)
+     *
+     * @tparam Signature The signature of the overload that is checked
+     */
+    template <class Signature, class Owner>
+    constexpr bool uses_display_default(Signature Owner::*) {
+        return is_display_base_s<Owner>::value;
+    }
+
+    /**
+     * Class static_display_c is a driver of which the drawing functions call
+     * the functions of the driver directly instead of through the virtual
+     * functions of display_c. The functions the driver doesn't implement use
+     * the defaults of display_c with this class as the display type, so
+     * set_pixel, set_pixels and the other primitives they are built on are
+     * direct calls that the compiler can inline.
+     *
+     * The class is final, so a module_c that uses it as display type calls
+     * the driver without virtual calls as well. Drivers that implement their
+     * own drawing functions keep using them.
+     *
+     * Usage:
+     * static_display_c<st7735_buffered_c<st7735_128x160_s>> display(...);
+     * coalescing_module_c<st7735_128x160_s, decltype(display)> module(comm,
+     *                                                            display);
+     *
+     * @tparam Driver The driver that is used, for example
+     * st7735_buffered_c<st7735_128x160_s>
+     */
+    template <class Driver>
+    class static_display_c final : public Driver {
+    protected:
+        // true when the driver uses the default of display_c
+        constexpr static bool default_write =
+            uses_display_default<void(uint16_t, uint16_t, uint16_t, uint16_t,
+                                      const uint16_t *)>(&Driver::set_pixels);
+        constexpr static bool default_fill =
+            uses_display_default<void(uint16_t, uint16_t, uint16_t, uint16_t,
+                                      const uint16_t)>(&Driver::set_pixels);
+        constexpr static bool default_characters =
+            uses_display_default<void(uint16_t, uint16_t, const char *,
+                                      std::size_t, uint16_t)>(
+                &Driver::set_characters);
+        constexpr static bool default_character =
+            uses_display_default<void(uint16_t, uint16_t, char, uint16_t)>(
+                &Driver::set_character);
+        constexpr static bool default_string =
+            uses_display_default<void(uint16_t, uint16_t, const char *,
+                                      uint16_t)>(&Driver::set_character);
+        constexpr static bool default_cursor_string =
+            uses_display_default<void(uint8_t, const char *)>(
+                &Driver::set_character);
+        constexpr static bool default_circle =
+            uses_display_default<void(uint16_t, uint16_t, uint16_t, bool,
+                                      const uint16_t)>(
+                &Driver::set_pixels_circle);
+        constexpr static bool default_cursor_circle =
+            uses_display_default<void(uint8_t, uint16_t, bool)>(
+                &Driver::set_pixels_circle);
+
+        /**
+         * @brief Write implementation for hwlib
+         *
+         * @param pos
+         * @param col
+         */
+        void write_implementation(hwlib::xy pos, hwlib::color col) override {
+            if (pos.x < this->clip_x_min || pos.x >= this->clip_x_max ||
+                pos.y < this->clip_y_min || pos.y >= this->clip_y_max) {
+                return;
+            }
+
+            Driver::set_pixel(pos.x, pos.y, Driver::color_to_pixel(col));
+        }
+
+    public:
+        using Driver::Driver;
+
+        uint16_t color_to_pixel(hwlib::color col) override {
+            return Driver::color_to_pixel(col);
+        }
+
+        void set_pixel(uint16_t x, uint16_t y, const uint16_t data) override {
+            Driver::set_pixel(x, y, data);
+        }
+
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height, const uint16_t *data) override {
+            if constexpr (default_write) {
+                this->template draw_pixels<static_display_c>(x, y, width,
+                                                             height, data);
+            } else {
+                Driver::set_pixels(x, y, width, height, data);
+            }
+        }
+
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height, const uint16_t data) override {
+            if constexpr (default_fill) {
+                this->template draw_fill<static_display_c>(x, y, width, height,
+                                                           data);
+            } else {
+                Driver::set_pixels(x, y, width, height, data);
+            }
+        }
+
+        void set_characters(uint16_t x, uint16_t y, const char *characters,
+                            std::size_t count,
+                            uint16_t pixel_color) override {
+            if constexpr (default_characters) {
+                this->template draw_characters<static_display_c>(
+                    x, y, characters, count, pixel_color);
+            } else {
+                Driver::set_characters(x, y, characters, count, pixel_color);
+            }
+        }
+
+        void set_character(uint16_t x, uint16_t y, char character,
+                           uint16_t pixel_color) override {
+            if constexpr (default_character) {
+                this->template draw_character<static_display_c>(
+                    x, y, character, pixel_color);
+            } else {
+                Driver::set_character(x, y, character, pixel_color);
+            }
+        }
+
+        void set_character(uint16_t x, uint16_t y, const char *characters,
+                           uint16_t pixel_color) override {
+            if constexpr (default_string) {
+                set_characters(x, y, characters,
+                               this->characters_in_row(x, characters),
+                               pixel_color);
+            } else {
+                Driver::set_character(x, y, characters, pixel_color);
+            }
+        }
+
+        void set_character(uint8_t cursor_target,
+                           const char *characters) override {
+            if constexpr (default_cursor_string) {
+                this->template draw_cursor_string<static_display_c>(
+                    cursor_target, characters);
+            } else {
+                Driver::set_character(cursor_target, characters);
+            }
+        }
+
+        void set_pixels_circle(uint16_t x, uint16_t y, uint16_t radius,
+                               bool filled, const uint16_t data) override {
+            if constexpr (default_circle) {
+                this->template draw_circle<static_display_c>(x, y, radius,
+                                                             filled, data);
+            } else {
+                Driver::set_pixels_circle(x, y, radius, filled, data);
+            }
+        }
+
+        void set_pixels_circle(uint8_t cursor_target, uint16_t radius,
+                               bool filled) override {
+            if constexpr (default_cursor_circle) {
+                const display_cursor_s &cursor = this->cursors[cursor_target];
+                set_pixels_circle(cursor.cursor_x, cursor.cursor_y, radius,
+                                  filled, color_to_pixel(cursor.cursor_color));
+            } else {
+                Driver::set_pixels_circle(cursor_target, radius, filled);
+            }
+        }
+    };
+} // namespace r2d2::display
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <display_adapter.hpp>
+#include <display_bus_stats.hpp>
+#include <display_pixel_format.hpp>
 #include <hwlib.hpp>
 #include <i2c_bus.hpp>
 
@@ -43,63 +45,50 @@ namespace r2d2::display {
             vertical_and_left_horizontal_scroll = 0x2A
         };
 
-        /// value to send over i2c before a command
-        constexpr static uint8_t ssd1306_cmd_prefix = 0x80;
+        /// value to send over i2c before a stream of commands, all following
+        /// bytes of the transaction are commands or their parameters
+        constexpr static uint8_t ssd1306_cmd_stream_prefix = 0x00;
 
         /// value to send over i2c before data
         constexpr static uint8_t ssd1306_data_prefix = 0x40;
 
-        /// SSD1306 chip initialization
+        /// SSD1306 chip initialization, sent as a single command stream
         constexpr static uint8_t ssd1306_initialization[] = {
-            ssd1306_cmd_prefix,
+            ssd1306_cmd_stream_prefix,
             (uint8_t)ssd1306_command::display_off,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_display_clock_div,
             0x80,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_multiplex,
             0x3f,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_display_offset,
             0x00,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_start_line | 0x00,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::charge_pump,
             0x14,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::memory_mode,
             0x00,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::seg_remap | 0x01,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::com_scan_dec,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_compins,
             0x12,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_contrast,
             0xcf,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_precharge,
             0xf1,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::set_vcom_detect,
             0x40,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::display_all_on_resume,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::normal_display,
-            ssd1306_cmd_prefix,
             (uint8_t)ssd1306_command::display_on};
     };
 
-    template <class DisplayScreen>
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
     class ssd1306_i2c_c : protected ssd1306_c,
-                          public display_c<DisplayScreen> {
+                          public display_c<DisplayScreen>,
+                          public BusStats {
     protected:
         /// The I2C bus
-        r2d2::i2c::i2c_bus_c bus;
+        r2d2::i2c::i2c_bus_c &bus;
         /// The device address
         uint8_t address;
         /// The current cursor location in the controller. Completely irrelevant
@@ -114,59 +103,69 @@ namespace r2d2::display {
               cursor(255, 255) {
         }
 
-        /// send a command without data
-        void command(ssd1306_command command) {
+        /// write data to the display in a single transaction
+        void bus_write(const uint8_t *data, std::size_t size) {
+            this->count_transaction(size);
+            bus.write(address, data, size);
+        }
+
+        /// send a sequence of commands and their parameters in a single
+        /// transaction
+        template <class... Bytes>
+        void command_sequence(Bytes... bytes) {
             // create command packet
-            uint8_t data[] = {ssd1306_cmd_prefix, (uint8_t)command};
+            const uint8_t data[] = {ssd1306_cmd_stream_prefix,
+                                    static_cast<uint8_t>(bytes)...};
 
-            // write command to the bus
-            bus.write(address, data, sizeof(data) / sizeof(uint8_t));
+            // write commands to the bus
+            bus_write(data, sizeof(data) / sizeof(uint8_t));
+        }
+
+        /// send a command without data
+        void command(ssd1306_command command) {
+            command_sequence(command);
         }
 
         /// send a command with one data byte
         void command(ssd1306_command command, uint8_t d0) {
-            // create command packet
-            uint8_t data[] = {ssd1306_cmd_prefix, (uint8_t)command,
-                              ssd1306_cmd_prefix, d0};
-
-            // write command to the bus
-            bus.write(address, data, sizeof(data) / sizeof(uint8_t));
+            command_sequence(command, d0);
         }
 
         /// send a command with two data bytes
         void command(ssd1306_command command, uint8_t d0, uint8_t d1) {
-            // create command packet
-            uint8_t data[] = {ssd1306_cmd_prefix, (uint8_t)command,
-                              ssd1306_cmd_prefix, d0,
-                              ssd1306_cmd_prefix, d1};
+            if (command == ssd1306_command::column_addr ||
+                command == ssd1306_command::page_addr) {
+                this->count_address_window_command();
+            }
 
-            // write command to the bus
-            bus.write(address, data, sizeof(data) / sizeof(uint8_t));
+            command_sequence(command, d0, d1);
         }
 
-        /// send one byte of data
-        void send_byte(uint8_t byte) {
-            // create data packet
-            uint8_t data[] = {ssd1306_data_prefix, byte};
+        /// set the columns and pages the following data is written to, in a
+        /// single transaction
+        void set_window(uint8_t first_column, uint8_t last_column,
+                        uint8_t first_page, uint8_t last_page) {
+            this->count_address_window_command();
+            this->count_address_window_command();
 
-            // write data to the bus
-            bus.write(address, data, sizeof(data) / sizeof(uint8_t));
+            command_sequence(ssd1306_command::column_addr, first_column,
+                             last_column, ssd1306_command::page_addr,
+                             first_page, last_page);
         }
 
-        /// write the pixel byte data at column x page y
-        void pixels_byte_write(hwlib::xy location, uint8_t data) {
-            // check if we need to update the current cursor of the screen
-            if (location != cursor) {
-                command(ssd1306_command::column_addr, location.x, 127);
-                command(ssd1306_command::page_addr, location.y, 7);
-                cursor = location;
-            }
-
-            // write data to the screen
-            send_byte(data);
-
-            // update the local cursor
-            cursor.x++; // TODO: cursor fallthrough
+        /// set the line that is shown at the top of the screen and the
+        /// columns and pages the following data is written to, in a single
+        /// transaction
+        void set_window(uint8_t start_line, uint8_t first_column,
+                        uint8_t last_column, uint8_t first_page,
+                        uint8_t last_page) {
+            this->count_address_window_command();
+            this->count_address_window_command();
+
+            command_sequence(
+                uint8_t(ssd1306_command::set_start_line) | start_line,
+                ssd1306_command::column_addr, first_column, last_column,
+                ssd1306_command::page_addr, first_page, last_page);
         }
 
     public:
@@ -190,7 +189,7 @@ namespace r2d2::display {
          */
         uint16_t color_to_pixel(hwlib::color col) override {
             // return as bool because we only need bools for the display
-            return (col == hwlib::white);
+            return mono_1bpp_s::from_color(col);
         }
     };
 
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <display_async_bus.hpp>
+#include <hwlib.hpp>
+#include <i2c_bus.hpp>
+#include <ssd1306_oled_buffered.hpp>
+
+namespace r2d2::display {
+    /**
+     * SSD1306 buffered interface for an oled that sends the buffer in the
+     * background.
+     *
+     * begin_flush() sets the address window and starts writing the buffer
+     * through an async_bus_c, which has to be bound to the address of the
+     * display. The transfer is moved forward by calling poll() until
+     * is_flushing() returns false.
+     *
+     * With double buffering the buffer is copied when the flush begins, so
+     * drawing can continue while the copy is sent.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam DoubleBuffer Send from a copy of the buffer
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, bool DoubleBuffer = false,
+              class BusStats = no_bus_stats_c>
+    class ssd1306_oled_async_buffered_c
+        : public ssd1306_oled_buffered_c<DisplayScreen, BusStats> {
+    protected:
+        // bus used for writing the pixel data
+        async_bus_c &async_bus;
+
+        // copy of the buffer that is being sent when double buffering
+        uint8_t front[DoubleBuffer ? (DisplayScreen::width *
+                                      DisplayScreen::height / 8) + 1
+                                   : 1] = {};
+
+        bool flushing = false;
+
+    public:
+        /**
+         * Construct the display driver by providing the communication bus,
+         * the address of the display and the bus for the pixel data.
+         */
+        ssd1306_oled_async_buffered_c(r2d2::i2c::i2c_bus_c &bus,
+                                      uint8_t address, async_bus_c &async_bus)
+            : ssd1306_oled_buffered_c<DisplayScreen, BusStats>(bus, address),
+              async_bus(async_bus) {
+        }
+
+        /**
+         * @brief Starts flushing the buffer
+         *
+         * @return false when a flush is still in progress
+         */
+        bool begin_flush() {
+            if (flushing) {
+                return false;
+            }
+
+            this->count_flush();
+
+            // update cursor of the display
+            this->set_window(0, 127, 0, 7);
+
+            const uint8_t *data = this->buffer;
+            if (DoubleBuffer) {
+                for (std::size_t i = 0; i < sizeof(this->buffer); i++) {
+                    front[i] = this->buffer[i];
+                }
+
+                data = front;
+            }
+
+            // the first byte of the buffer is the data prefix
+            this->count_transaction(sizeof(this->buffer));
+            async_bus.begin_write(data, sizeof(this->buffer));
+            flushing = true;
+
+            return true;
+        }
+
+        /**
+         * @brief Moves the flush forward
+         *
+         * @return true while the flush is in progress
+         */
+        bool poll() {
+            if (flushing && async_bus.poll()) {
+                flushing = false;
+            }
+
+            return flushing;
+        }
+
+        /**
+         * @brief Returns true while a flush is in progress
+         *
+         */
+        bool is_flushing() const {
+            return flushing;
+        }
+
+        /**
+         * Flushes the data to the display and waits until it is done.
+         */
+        void flush() override {
+            // wait for the previous flush
+            while (poll()) {
+            }
+
+            begin_flush();
+
+            while (poll()) {
+            }
+        }
+    };
+
+} // namespace r2d2::display
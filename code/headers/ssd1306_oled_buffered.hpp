@@ -1,5 +1,6 @@
 #pragma once
 
+#include <display_fill.hpp>
 #include <hwlib.hpp>
 #include <i2c_bus.hpp>
 #include <ssd1306.hpp>
@@ -12,10 +13,10 @@ namespace r2d2::display {
      *
      * The template parameters are used for the parent class.
      */
-    template <class DisplayScreen>
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
     class ssd1306_oled_buffered_c
-        : public ssd1306_i2c_c<DisplayScreen> {
-    private:
+        : public ssd1306_i2c_c<DisplayScreen, BusStats> {
+    protected:
         /**
          * The buffer with the pixel data
          * The first byte is used for the data-prefix that the display driver
@@ -30,14 +31,15 @@ namespace r2d2::display {
          * the address of the display.
          */
         ssd1306_oled_buffered_c(r2d2::i2c::i2c_bus_c &bus,
-                                uint8_t &address)
-            : ssd1306_i2c_c<DisplayScreen>(bus, address) {
+                                uint8_t address)
+            : ssd1306_i2c_c<DisplayScreen, BusStats>(bus, address) {
             // set the command for writing to the screen
             buffer[0] = this->ssd1306_data_prefix;
 
             // write the initalisation sequence to the screen
-            bus.write(address, this->ssd1306_initialization,
-                      sizeof(this->ssd1306_initialization) / sizeof(uint8_t));
+            this->bus_write(this->ssd1306_initialization,
+                            sizeof(this->ssd1306_initialization) /
+                                sizeof(uint8_t));
         }
 
         /**
@@ -59,18 +61,39 @@ namespace r2d2::display {
                 buffer[t_index] &= ~(0x01 << (y % 8));
             }
         }
+
+        /**
+         * @brief Fill multiple pixels with the same color. Whole bytes of the
+         * buffer are written at once where possible.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data data != 0 will set the pixels, data = 0 will clear them
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height, const uint16_t data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            mono_buffer_fill_rectangle(&buffer[1], DisplayScreen::width,
+                                       rect.x, rect.y, rect.width,
+                                       rect.height, data != 0);
+        }
+
+        using ssd1306_i2c_c<DisplayScreen, BusStats>::set_pixels;
+
         /**
          * This clears the display this overrides the default clear of hwlib
-         * because it is realy inefficient for this screen.
+         * because it is realy inefficient for this screen. Only the pixels
+         * inside the clip rectangle are cleared.
          */
         void clear(hwlib::color col) override {
-            // get a the data for the screen
-            const uint8_t clear_col = (col == hwlib::white) ? 0xFF : 0x00;
-
-            // set all values to the color of the data
-            for (uint_fast16_t i = 1; i < sizeof(buffer); ++i) {
-                buffer[i] = clear_col;
-            }
+            set_pixels(0, 0, DisplayScreen::width, DisplayScreen::height,
+                       this->color_to_pixel(col));
         }
 
         /**
@@ -88,14 +111,13 @@ namespace r2d2::display {
          * is called, it will then push the entirety of the buffer to the
          * display at once.
          */
-        void flush() {
+        void flush() override {
+            this->count_flush();
+
             // update cursor of the display
-            ssd1306_oled_buffered_c::command(
-                ssd1306_oled_buffered_c::ssd1306_command::column_addr, 0, 127);
-            ssd1306_oled_buffered_c::command(
-                ssd1306_oled_buffered_c::ssd1306_command::page_addr, 0, 7);
+            this->set_window(0, 127, 0, 7);
             // write data to the screen
-            this->bus.write(this->address, this->buffer, sizeof(this->buffer));
+            this->bus_write(this->buffer, sizeof(this->buffer));
         }
     };
 
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <display_fill.hpp>
+#include <hwlib.hpp>
+#include <i2c_bus.hpp>
+#include <ssd1306_oled_buffered.hpp>
+
+namespace r2d2::display {
+    /**
+     * SSD1306 buffered interface for an oled with a scrolling text console
+     * for log-style screens. Extends from
+     * r2d2::display::ssd1306_oled_buffered_c
+     *
+     * Every page of the display is a line of the console. When the console
+     * is full, a new line is written over the oldest line and the display
+     * start line moves one page down, so the controller scrolls the screen
+     * instead of the driver. Only the page of the new line is sent.
+     *
+     * After the console scrolled, the buffer is in the order of the display
+     * memory: the top line of the screen is at page top_page() of the
+     * buffer. Drawing functions and flush() work on the buffer, clear()
+     * scrolls the screen back.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
+    class ssd1306_oled_console_c
+        : public ssd1306_oled_buffered_c<DisplayScreen, BusStats> {
+    protected:
+        constexpr static uint8_t page_count = DisplayScreen::height / 8;
+
+        /// The page of the buffer that is shown at the top of the screen
+        uint8_t top = 0;
+
+        /// The amount of lines on the console
+        uint8_t line_count = 0;
+
+        /**
+         * @brief Sends a page of the buffer to the display. The start line
+         * is set in the same command stream as the address window.
+         *
+         * @param page
+         */
+        void write_line_page(uint8_t page) {
+            this->set_window(top * 8, 0, DisplayScreen::width - 1, page, page);
+
+            // the data is sent straight from the buffer, the byte in front
+            // of it is the data prefix while it is being written
+            uint8_t *data = &this->buffer[page * DisplayScreen::width];
+            const uint8_t previous = *data;
+
+            *data = this->ssd1306_data_prefix;
+            this->bus_write(data, DisplayScreen::width + 1);
+            *data = previous;
+        }
+
+    public:
+        /**
+         * Construct the display driver by providing the communication bus and
+         * the address of the display.
+         */
+        ssd1306_oled_console_c(r2d2::i2c::i2c_bus_c &bus, uint8_t address)
+            : ssd1306_oled_buffered_c<DisplayScreen, BusStats>(bus, address) {
+        }
+
+        /**
+         * @brief Returns the page of the buffer that is shown at the top of
+         * the screen
+         */
+        uint8_t top_page() const {
+            return top;
+        }
+
+        /**
+         * @brief Writes a line below the last line of the console and sends
+         * it to the display. When the console is full the screen scrolls up
+         * by one line. Characters that don't fit on the line are dropped.
+         *
+         * @param characters
+         */
+        void write_line(const char *characters) {
+            uint8_t page;
+
+            if (line_count < page_count) {
+                page = (top + line_count) % page_count;
+                line_count++;
+            } else {
+                // the oldest line is replaced and becomes the bottom line
+                page = top;
+                top = (top + 1) % page_count;
+            }
+
+            mono_buffer_fill_rectangle(
+                &this->buffer[1], DisplayScreen::width, 0, page * 8,
+                DisplayScreen::width, 8,
+                this->color_to_pixel(this->background) != 0);
+
+            this->set_character(0, page * 8, characters,
+                                this->color_to_pixel(this->foreground));
+
+            write_line_page(page);
+        }
+
+        /**
+         * Clears the buffer and the lines of the console, a scrolled screen
+         * is scrolled back to the first page of the buffer.
+         */
+        void clear(hwlib::color col) override {
+            ssd1306_oled_buffered_c<DisplayScreen, BusStats>::clear(col);
+
+            line_count = 0;
+
+            if (top != 0) {
+                top = 0;
+                this->command_sequence(
+                    ssd1306_oled_console_c::ssd1306_command::set_start_line);
+            }
+        }
+
+        using ssd1306_oled_buffered_c<DisplayScreen, BusStats>::clear;
+    };
+
+} // namespace r2d2::display
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <hwlib.hpp>
+#include <i2c_bus.hpp>
+#include <ssd1306_oled_buffered.hpp>
+
+namespace r2d2::display {
+    /**
+     * SSD1306 buffered interface for an oled that only sends the bytes that
+     * changed since the last flush.
+     *
+     * A shadow copy of the display memory is kept. On a flush the buffer is
+     * compared with the shadow page by page and only the changed runs of
+     * bytes are written, every run in its own column_addr/page_addr window.
+     * Runs that are close to each other are sent as one run when addressing
+     * a new window would cost more than sending the unchanged bytes between
+     * them.
+     *
+     * The template parameters are used for the parent class.
+     */
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
+    class ssd1306_oled_diff_buffered_c
+        : public ssd1306_oled_buffered_c<DisplayScreen, BusStats> {
+    protected:
+        /// amount of bytes in a single page
+        constexpr static uint8_t page_size = DisplayScreen::width;
+
+        /// amount of pages on the display
+        constexpr static uint8_t page_count = DisplayScreen::height / 8;
+
+        /**
+         * The amount of bytes needed to address a new window. The
+         * column_addr and page_addr commands are a single command stream of
+         * 7 bytes, every i2c transaction adds an address byte and the data
+         * needs a new prefix.
+         */
+        constexpr static uint8_t window_cost = 10;
+
+        /// the data the display currently holds
+        uint8_t shadow[page_size * page_count] = {};
+
+        /// false when the contents of the display are unknown
+        bool shadow_valid = false;
+
+        /**
+         * @brief Write a run of bytes in a single page to the display
+         *
+         * @param page
+         * @param first first column of the run
+         * @param last last column of the run
+         */
+        void write_run(uint8_t page, uint8_t first, uint8_t last) {
+            // set the window to the run
+            this->set_window(first, last, page, page);
+
+            // the data needs the data prefix in front of it
+            uint8_t data[page_size + 1];
+            data[0] = this->ssd1306_data_prefix;
+
+            const std::size_t offset = (page * page_size) + first;
+            const std::size_t size = last - first + 1;
+
+            for (std::size_t i = 0; i < size; i++) {
+                data[i + 1] = this->buffer[offset + i + 1];
+                shadow[offset + i] = this->buffer[offset + i + 1];
+            }
+
+            // write data to the screen
+            this->bus_write(data, size + 1);
+        }
+
+    public:
+        /**
+         * Construct the display driver by providing the communication bus and
+         * the address of the display.
+         */
+        ssd1306_oled_diff_buffered_c(r2d2::i2c::i2c_bus_c &bus,
+                                     uint8_t address)
+            : ssd1306_oled_buffered_c<DisplayScreen, BusStats>(bus, address) {
+        }
+
+        /**
+         * Forget what the display holds, the next flush will send the
+         * complete buffer.
+         */
+        void invalidate() {
+            shadow_valid = false;
+        }
+
+        /**
+         * Flushes the changed data to the display.
+         * The first flush sends the entire buffer, after that only the runs
+         * of bytes that differ from the shadow are sent.
+         */
+        void flush() override {
+            if (!shadow_valid) {
+                ssd1306_oled_buffered_c<DisplayScreen, BusStats>::flush();
+
+                for (std::size_t i = 0; i < sizeof(shadow); i++) {
+                    shadow[i] = this->buffer[i + 1];
+                }
+
+                shadow_valid = true;
+                return;
+            }
+
+            this->count_flush();
+
+            for (uint8_t page = 0; page < page_count; page++) {
+                const uint8_t *current = &this->buffer[(page * page_size) + 1];
+                const uint8_t *previous = &shadow[page * page_size];
+
+                // first and last changed column of the current run, -1 means
+                // there is no run
+                int start = -1;
+                int end = -1;
+
+                for (int column = 0; column < page_size; column++) {
+                    if (current[column] == previous[column]) {
+                        continue;
+                    }
+
+                    if (start < 0) {
+                        start = column;
+                    } else if (column - end - 1 > window_cost) {
+                        // the gap is too big, send the run on its own
+                        write_run(page, start, end);
+                        start = column;
+                    }
+
+                    end = column;
+                }
+
+                if (start >= 0) {
+                    write_run(page, start, end);
+                }
+            }
+        }
+    };
+
+} // namespace r2d2::display
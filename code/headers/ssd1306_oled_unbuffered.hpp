@@ -1,5 +1,6 @@
 #pragma once
 
+#include <display_fill.hpp>
 #include <hwlib.hpp>
 #include <i2c_bus.hpp>
 #include <ssd1306.hpp>
@@ -10,11 +11,18 @@ namespace r2d2::display {
      * Implements hwlib::window to easily use text and drawing functions that
      * are already implemented. Extends from r2d2::display::ssd1306_i2c_c
      *
+     * Changed bytes are collected in a write combining queue that holds a
+     * few ranges of columns for every page. Every range is sent from the
+     * buffer as a single burst when the queue is drained: at the end of
+     * every drawing function, or when a byte of a page is too far from all
+     * ranges of that page. Pixels written through hwlib are only drained on
+     * flush().
+     *
      * The template parameters are used for the parent class.
      */
-    template <class DisplayScreen>
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
     class ssd1306_oled_unbuffered_c
-        : public ssd1306_i2c_c<DisplayScreen> {
+        : public ssd1306_i2c_c<DisplayScreen, BusStats> {
     private:
         /**
          * The buffer with the pixel data
@@ -24,6 +32,169 @@ namespace r2d2::display {
         uint8_t buffer[DisplayScreen::width * DisplayScreen::height / 8 + 1] =
             {};
 
+    protected:
+        /// amount of pages on the display
+        constexpr static uint8_t page_count = DisplayScreen::height / 8;
+
+        /**
+         * The amount of bytes needed to address a new window. The
+         * column_addr and page_addr commands are a single command stream of
+         * 7 bytes, every i2c transaction adds an address byte and the data
+         * needs a new prefix.
+         */
+        constexpr static uint8_t window_cost = 10;
+
+        /// the maximum amount of queued ranges of columns in a page
+        constexpr static uint8_t ranges_per_page = 2;
+
+        /// the queued ranges of columns of every page
+        struct column_range_s {
+            uint8_t first;
+            uint8_t last;
+        };
+
+        column_range_s ranges[page_count][ranges_per_page] = {};
+        uint8_t range_count[page_count] = {};
+
+        /// the amount of drawing functions that are being executed, the
+        /// queue is drained when the outermost one is done
+        uint8_t draw_depth = 0;
+
+        /**
+         * @brief Sends a range of columns of a page to the display as one
+         * burst
+         *
+         * @param page
+         * @param range
+         */
+        void write_range(uint8_t page, const column_range_s &range) {
+            const uint8_t count = range.last - range.first + 1;
+
+            // check if we need to update the current cursor of the screen
+            if (hwlib::xy(range.first, page) != this->cursor) {
+                this->set_window(range.first, 127, page, 7);
+            }
+
+            // the data is sent straight from the buffer, the byte in front
+            // of it is the data prefix while it is being written
+            uint8_t *data =
+                &buffer[range.first + (page * DisplayScreen::width)];
+            const uint8_t previous = *data;
+
+            *data = this->ssd1306_data_prefix;
+            this->bus_write(data, count + 1);
+            *data = previous;
+
+            this->cursor = hwlib::xy(range.first + count, page);
+        }
+
+        /**
+         * @brief Sends the queued ranges of a page to the display
+         *
+         * @param page
+         */
+        void drain_page(uint8_t page) {
+            for (uint8_t i = 0; i < range_count[page]; i++) {
+                write_range(page, ranges[page][i]);
+            }
+
+            range_count[page] = 0;
+        }
+
+        /**
+         * @brief Sends all queued bytes to the display
+         *
+         */
+        void drain() {
+            for (uint8_t page = 0; page < page_count; page++) {
+                drain_page(page);
+            }
+        }
+
+        /**
+         * @brief Returns true when sending the unchanged bytes between a
+         * column and a range is cheaper than a new window
+         *
+         * @param first
+         * @param last
+         * @param range
+         */
+        static bool is_close(uint8_t first, uint8_t last,
+                             const column_range_s &range) {
+            return last + window_cost >= range.first &&
+                   first <= range.last + window_cost;
+        }
+
+        /**
+         * @brief Queues a changed byte of the display. The byte is combined
+         * with a queued range of its page, unless the unchanged bytes in
+         * between would cost more than a new window.
+         *
+         * @param column
+         * @param page
+         */
+        void queue(uint8_t column, uint8_t page) {
+            column_range_s *page_ranges = ranges[page];
+            uint8_t &count = range_count[page];
+
+            for (uint8_t i = 0; i < count; i++) {
+                column_range_s &range = page_ranges[i];
+
+                if (!is_close(column, column, range)) {
+                    continue;
+                }
+
+                if (column < range.first) {
+                    range.first = column;
+                }
+                if (column > range.last) {
+                    range.last = column;
+                }
+
+                // the range might have grown close to another range
+                for (uint8_t j = 0; j < count; j++) {
+                    if (j == i ||
+                        !is_close(range.first, range.last, page_ranges[j])) {
+                        continue;
+                    }
+
+                    if (page_ranges[j].first < range.first) {
+                        range.first = page_ranges[j].first;
+                    }
+                    if (page_ranges[j].last > range.last) {
+                        range.last = page_ranges[j].last;
+                    }
+
+                    page_ranges[j] = page_ranges[--count];
+                    break;
+                }
+
+                return;
+            }
+
+            if (count == ranges_per_page) {
+                drain_page(page);
+            }
+
+            page_ranges[count++] = {column, column};
+        }
+
+        /**
+         * @brief Executes a drawing function and drains the queue when it is
+         * the outermost one
+         *
+         * @param draw
+         */
+        template <class Draw>
+        void combined(Draw &&draw) {
+            draw_depth++;
+            draw();
+
+            if (--draw_depth == 0) {
+                drain();
+            }
+        }
+
     public:
         /**
          * Construct the display driver by providing the communication bus and
@@ -31,14 +202,15 @@ namespace r2d2::display {
          */
         ssd1306_oled_unbuffered_c(r2d2::i2c::i2c_bus_c &bus,
                                   uint8_t address)
-            : ssd1306_i2c_c<DisplayScreen>(bus, address) {
+            : ssd1306_i2c_c<DisplayScreen, BusStats>(bus, address) {
 
             // set the command for writing to the screen
             buffer[0] = this->ssd1306_data_prefix;
 
             // write the initalisation sequence to the screen
-            bus.write(address, this->ssd1306_initialization,
-                      sizeof(this->ssd1306_initialization) / sizeof(uint8_t));
+            this->bus_write(this->ssd1306_initialization,
+                            sizeof(this->ssd1306_initialization) /
+                                sizeof(uint8_t));
         }
 
         /**
@@ -61,32 +233,155 @@ namespace r2d2::display {
                 buffer[t_index] &= ~(0x01 << (y % 8));
             }
 
-            // write pixel byte to screen
-            this->pixels_byte_write(hwlib::xy(x, y / 8), buffer[t_index]);
+            // queue the pixel byte for the screen
+            queue(x, y / 8);
+        }
+
+        /**
+         * @brief Write multiple pixels to the screen
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height, const uint16_t *data) override {
+            combined([&] {
+                ssd1306_i2c_c<DisplayScreen, BusStats>::set_pixels(
+                    x, y, width, height, data);
+            });
+        }
+
+        /**
+         * @brief Fill multiple pixels with the same color. Every changed
+         * byte is queued once.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data data != 0 will set the pixels, data = 0 will clear them
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height, const uint16_t data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            mono_buffer_fill_rectangle(&buffer[1], DisplayScreen::width,
+                                       rect.x, rect.y, rect.width,
+                                       rect.height, data != 0);
+
+            combined([&] {
+                for (uint8_t page = rect.y / 8;
+                     page <= (rect.y + rect.height - 1) / 8; page++) {
+                    for (uint8_t column = rect.x;
+                         column < rect.x + rect.width; column++) {
+                        queue(column, page);
+                    }
+                }
+            });
+        }
+
+        /**
+         * @brief Draws a number of characters next to each other
+         *
+         * @param x
+         * @param y
+         * @param characters
+         * @param count
+         * @param pixel_color
+         */
+        void set_characters(uint16_t x, uint16_t y, const char *characters,
+                            std::size_t count,
+                            uint16_t pixel_color) override {
+            combined([&] {
+                ssd1306_i2c_c<DisplayScreen, BusStats>::set_characters(
+                    x, y, characters, count, pixel_color);
+            });
+        }
+
+        /**
+         * @brief Sets character in a single color
+         *
+         * @param x
+         * @param y
+         * @param character
+         * @param pixel_color
+         */
+        void set_character(uint16_t x, uint16_t y, char character,
+                           uint16_t pixel_color) override {
+            combined([&] {
+                ssd1306_i2c_c<DisplayScreen, BusStats>::set_character(
+                    x, y, character, pixel_color);
+            });
+        }
+
+        using ssd1306_i2c_c<DisplayScreen, BusStats>::set_character;
+
+        /**
+         * @brief Fill multiple pixels in a circle shape with the same color
+         *
+         * @param x
+         * @param y
+         * @param radius
+         * @param filled
+         * @param data
+         */
+        void set_pixels_circle(uint16_t x, uint16_t y, uint16_t radius,
+                               bool filled, const uint16_t data) override {
+            combined([&] {
+                ssd1306_i2c_c<DisplayScreen, BusStats>::set_pixels_circle(
+                    x, y, radius, filled, data);
+            });
+        }
+
+        using ssd1306_i2c_c<DisplayScreen, BusStats>::set_pixels_circle;
+
+        /**
+         * @brief Sends the bytes that are still queued, for example after
+         * drawing through hwlib
+         *
+         */
+        void flush() override {
+            drain();
         }
 
         /**
          * This clears the display this overrides the default clear of hwlib
-         * because it is realy inefficient for this screen.
+         * because it is realy inefficient for this screen. Only the pixels
+         * inside the clip rectangle are cleared.
          */
         void clear(hwlib::color col) override {
-            // get a the data for the screen
-            const uint8_t clear_color = (col == hwlib::white) ? 0xFF : 0x00;
+            // a clipped clear only sends the bytes inside the clip
+            if (this->clip_x_min != 0 || this->clip_y_min != 0 ||
+                this->clip_x_max != DisplayScreen::width ||
+                this->clip_y_max != DisplayScreen::height) {
+                set_pixels(0, 0, DisplayScreen::width, DisplayScreen::height,
+                           this->color_to_pixel(col));
+                return;
+            }
 
-            // clear the internal buffer with the screen color
-            for (uint16_t i = 1; i < sizeof(buffer); i++) {
-                buffer[i] = clear_color;
+            // the queued bytes are overwritten anyway
+            for (uint8_t page = 0; page < page_count; page++) {
+                range_count[page] = 0;
             }
 
+            // clear the internal buffer with the screen color, the first
+            // byte is the data prefix
+            mono_buffer_fill_rectangle(&buffer[1], DisplayScreen::width, 0, 0,
+                                       DisplayScreen::width,
+                                       DisplayScreen::height,
+                                       this->color_to_pixel(col));
+
             // update cursor of the display
-            ssd1306_oled_unbuffered_c::command(
-                ssd1306_oled_unbuffered_c::ssd1306_command::column_addr, 0,
-                127);
-            ssd1306_oled_unbuffered_c::command(
-                ssd1306_oled_unbuffered_c::ssd1306_command::page_addr, 0, 7);
+            this->set_window(0, 127, 0, 7);
 
             // write data to the screen
-            this->bus.write(this->address, this->buffer, sizeof(this->buffer));
+            this->bus_write(this->buffer, sizeof(this->buffer));
 
             // update the cursor
             this->cursor = hwlib::xy(0, 0);
@@ -1,13 +1,25 @@
 #pragma once
 
 #include <display_adapter.hpp>
+#include <display_bus_stats.hpp>
+#include <display_pixel_format.hpp>
 #include <hwlib.hpp>
 
 
 namespace r2d2::display {
-
-    template <class DisplayScreen>
-    class st7735_c : public display_c<DisplayScreen> {
+    /**
+     * Class st7735_c contains the commands and bus handling of the st7735
+     * chip that are shared by all st7735 drivers.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam PixelFormat How pixels are converted and stored, see
+     * display_pixel_format.hpp
+     * @tparam BusStats bus_stats_c to count the bus traffic, see
+     * display_bus_stats.hpp
+     */
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_c : public display_c<DisplayScreen>, public BusStats {
     protected:
         // all the commands for the display
         constexpr static uint8_t SWRESET = 0x01;
@@ -26,6 +38,8 @@ namespace r2d2::display {
         constexpr static uint8_t RAMWR = 0x2C;
         constexpr static uint8_t RAMRD = 0x2E;
         constexpr static uint8_t PTLAR = 0x30;
+        constexpr static uint8_t VSCRDEF = 0x33;
+        constexpr static uint8_t VSCRSADD = 0x37;
         constexpr static uint8_t COLMOD = 0x3A;
         constexpr static uint8_t MADCTL = 0x36;
         constexpr static uint8_t FRMCTR1 = 0xB1;
@@ -54,6 +68,23 @@ namespace r2d2::display {
         // When using the small screen, y_offset is 1;
         constexpr static uint8_t y_offset = DisplayScreen::y_offset;
 
+        // amount of rows in the memory of the st7735, the rows of the screen
+        // start at y_offset
+        constexpr static uint16_t memory_height = DisplayScreen::memory_height;
+
+        // amount of pixels that are converted before they are written to
+        // the bus when streaming pixel data
+        constexpr static std::size_t staging_size = 32;
+
+        // the rows of the screen that are scrolled by the display
+        uint16_t scroll_y = 0;
+        uint16_t scroll_rows = DisplayScreen::height;
+
+        // the rows that are shown in partial mode, inclusive
+        uint16_t partial_y_min = 0;
+        uint16_t partial_y_max = DisplayScreen::height - 1;
+        bool partial = false;
+
         // display bus
         hwlib::spi_bus &bus;
 
@@ -62,6 +93,21 @@ namespace r2d2::display {
         hwlib::pin_out &dc;
         hwlib::pin_out &reset;
 
+        // block of pixels used by fill_pixels, in the byte order of the screen
+        uint16_t fill_block[staging_size] = {};
+        uint16_t fill_block_color = 0;
+        bool fill_block_valid = false;
+
+        /**
+         * @brief Sets the display in data or command mode
+         *
+         * @param data true for data, false for commands
+         */
+        void write_dc(bool data) {
+            this->count_dc(data);
+            dc.write(data);
+        }
+
         /**
          * @brief Write a command to the screen
          *
@@ -71,11 +117,20 @@ namespace r2d2::display {
         template <typename... Args>
         void write_command(Args &&... args) {
             // set display in command mode
-            dc.write(false);
+            write_dc(false);
 
             // convert all commands to a array
             const uint8_t commands[] = {static_cast<uint8_t>(args)...};
 
+            this->count_transaction(sizeof(commands));
+            if constexpr (BusStats::bus_stats_enabled) {
+                for (const uint8_t command : commands) {
+                    if (command == CASET || command == RASET) {
+                        this->count_address_window_command();
+                    }
+                }
+            }
+
             // write all commands on the bus
             auto transaction = bus.transaction(cs);
             transaction.write(sizeof(commands), commands);
@@ -89,7 +144,8 @@ namespace r2d2::display {
          */
         void write_data(const uint8_t *data, std::size_t size) {
             // set display in data mode
-            dc.write(true);
+            write_dc(true);
+            this->count_transaction(size);
 
             auto transaction = bus.transaction(cs);
             transaction.write(size, data);
@@ -111,6 +167,111 @@ namespace r2d2::display {
             write_data(commands, sizeof(commands));
         }
 
+        /**
+         * @brief Write multiple rows of display data to the screen in a
+         * single transaction
+         *
+         * @param data pointer to the first byte of the first row
+         * @param row_size amount of bytes to write for every row
+         * @param stride amount of bytes between the start of two rows
+         * @param rows amount of rows to write
+         */
+        void write_data_rows(const uint8_t *data, std::size_t row_size,
+                             std::size_t stride, std::size_t rows) {
+            // set display in data mode
+            write_dc(true);
+            this->count_transaction(row_size * rows);
+
+            auto transaction = bus.transaction(cs);
+            for (std::size_t row = 0; row < rows; row++) {
+                transaction.write(row_size, data + (row * stride));
+            }
+        }
+
+        /**
+         * @brief Write rows of pixels to the screen in a single transaction.
+         * The pixels are converted to the byte order of the screen in a small
+         * staging buffer, which is written to the bus every time it is full.
+         *
+         * @param data pixels in the byte order of the processor
+         * @param width amount of pixels to write for every row
+         * @param stride amount of pixels between the start of two rows
+         * @param rows amount of rows to write
+         */
+        void write_pixels(const uint16_t *data, std::size_t width,
+                          std::size_t stride, std::size_t rows) {
+            uint16_t staging[staging_size];
+
+            // set display in data mode
+            write_dc(true);
+            this->count_transaction(width * rows * 2);
+
+            auto transaction = bus.transaction(cs);
+            for (std::size_t row = 0; row < rows; row++) {
+                const uint16_t *source = data + (row * stride);
+                std::size_t count = width;
+
+                while (count > 0) {
+                    const std::size_t chunk =
+                        count < staging_size ? count : staging_size;
+
+                    // unfortunaly the arduino due is little endian
+                    swap_bytes(source, staging, chunk);
+
+                    transaction.write(chunk * 2, (uint8_t *)staging);
+
+                    source += chunk;
+                    count -= chunk;
+                }
+            }
+        }
+
+        /**
+         * @brief Write pixels to the screen in a single transaction
+         *
+         * @param data pixels in the byte order of the processor
+         * @param count amount of pixels to write
+         */
+        void write_pixels(const uint16_t *data, std::size_t count) {
+            write_pixels(data, count, count, 1);
+        }
+
+        /**
+         * @brief Fill pixels on the screen with the same color in a single
+         * transaction. A block of pixels in the byte order of the screen is
+         * kept and written to the bus repeatedly.
+         *
+         * @param data color of the pixels in the byte order of the processor
+         * @param count amount of pixels to write
+         */
+        void fill_pixels(uint16_t data, std::size_t count) {
+            // only rebuild the block when the color changes
+            if (!fill_block_valid || fill_block_color != data) {
+                const uint16_t inverted_data = swap_bytes(data);
+
+                for (std::size_t i = 0; i < staging_size; i++) {
+                    fill_block[i] = inverted_data;
+                }
+
+                fill_block_color = data;
+                fill_block_valid = true;
+            }
+
+            // set display in data mode
+            write_dc(true);
+            this->count_transaction(count * 2);
+
+            auto transaction = bus.transaction(cs);
+            while (count > 0) {
+                const std::size_t chunk =
+                    count < staging_size ? count : staging_size;
+
+                transaction.write(chunk * 2, (uint8_t *)fill_block);
+
+                count -= chunk;
+            }
+        }
+
         /**
          * @brief inits the display
          *
@@ -223,6 +384,71 @@ namespace r2d2::display {
                        static_cast<uint8_t>(y_max >> 8), static_cast<uint8_t>(y_max));
         }
 
+        /**
+         * @brief Returns the row of the memory of the st7735 that a row of
+         * the screen is stored in. The scroll and partial commands use the
+         * rows of the memory, which are mirrored by MADCTL.
+         *
+         * @param y
+         * @return uint16_t
+         */
+        constexpr static uint16_t memory_row(uint16_t y) {
+            return memory_height - 1 - (y + y_offset);
+        }
+
+        /**
+         * @brief Defines the rows of the screen that are scrolled by the
+         * display, the rows above and below it are fixed. The area is
+         * limited to the screen.
+         *
+         * @param y first row of the scroll area
+         * @param scroll_height amount of rows in the scroll area
+         */
+        void set_scroll_area(uint16_t y, uint16_t scroll_height) {
+            if (scroll_height == 0 || y >= height) {
+                return;
+            }
+            if (y + scroll_height > height) {
+                scroll_height = height - y;
+            }
+
+            scroll_y = y;
+            scroll_rows = scroll_height;
+
+            // the memory is mirrored, so the last row of the area is the
+            // first row of the area in the memory
+            const uint16_t top_fixed = memory_row(y + scroll_height - 1);
+            const uint16_t bottom_fixed =
+                memory_height - top_fixed - scroll_height;
+
+            write_command(VSCRDEF);
+            write_data(static_cast<uint8_t>(top_fixed >> 8),
+                       static_cast<uint8_t>(top_fixed),
+                       static_cast<uint8_t>(scroll_height >> 8),
+                       static_cast<uint8_t>(scroll_height),
+                       static_cast<uint8_t>(bottom_fixed >> 8),
+                       static_cast<uint8_t>(bottom_fixed));
+        }
+
+        /**
+         * @brief Sets the row that is shown at the top of the scroll area,
+         * the rows below it follow and wrap around within the scroll area
+         *
+         * @param y a row of the scroll area
+         */
+        void set_scroll_start(uint16_t y) {
+            const uint16_t top_fixed = memory_row(scroll_y + scroll_rows - 1);
+
+            // the display scrolls through the memory in the other direction
+            // than the rows of the screen
+            const uint16_t start =
+                top_fixed + ((scroll_rows - (y - scroll_y)) % scroll_rows);
+
+            write_command(VSCRSADD);
+            write_data(static_cast<uint8_t>(start >> 8),
+                       static_cast<uint8_t>(start));
+        }
+
         /**
          * @brief Construct a new st7735_c object
          *
@@ -254,17 +480,80 @@ namespace r2d2::display {
          */
         constexpr static uint8_t height = DisplayScreen::height;
 
+        /**
+         * @brief Only shows a band of rows of the screen, the rest of the
+         * screen is off. The buffered drivers only flush the changes inside
+         * the band until the normal mode is set again.
+         *
+         * @param y first row of the band
+         * @param band_height amount of rows in the band
+         */
+        void set_partial_area(uint16_t y, uint16_t band_height) {
+            if (band_height == 0 || y >= height) {
+                return;
+            }
+            if (y + band_height > height) {
+                band_height = height - y;
+            }
+
+            partial_y_min = y;
+            partial_y_max = y + band_height - 1;
+            partial = true;
+
+            // the memory is mirrored, the band ends at the first row of the
+            // band in the memory
+            const uint16_t start = memory_row(partial_y_max);
+            const uint16_t end = memory_row(partial_y_min);
+
+            write_command(PTLAR);
+            write_data(static_cast<uint8_t>(start >> 8),
+                       static_cast<uint8_t>(start),
+                       static_cast<uint8_t>(end >> 8),
+                       static_cast<uint8_t>(end));
+            write_command(PTLON);
+        }
+
+        /**
+         * @brief Shows the whole screen again after set_partial_area
+         *
+         */
+        void set_normal_mode() {
+            if (!partial) {
+                return;
+            }
+
+            partial = false;
+            write_command(NORON);
+        }
+
+        /**
+         * @brief Returns true when only a band of rows is shown
+         *
+         */
+        bool is_partial_mode() const {
+            return partial;
+        }
+
         /**
          * @brief Converst a hwlib::color to a uint16_t in the format the screen
-         * wants
+         * wants. Can be used for colors that are known at compile time.
          *
          * @param col
          * @return constexpr uint16_t
          */
+        constexpr static uint16_t pixel(hwlib::color col) {
+            return PixelFormat::from_color(col);
+        }
+
+        /**
+         * @brief Converst a hwlib::color to a uint16_t in the format the screen
+         * wants
+         *
+         * @param col
+         * @return uint16_t
+         */
         uint16_t color_to_pixel(hwlib::color col) override {
-            return (uint16_t(col.red) * 0x1F / 0xFF) << 11 |
-                   (uint16_t(col.green) * 0x3F / 0xFF) << 5 |
-                   (uint16_t(col.blue) * 0x1F / 0xFF);
+            return pixel(col);
         }
     };
 } // namespace r2d2::display
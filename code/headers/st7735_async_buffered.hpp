@@ -0,0 +1,239 @@
+#pragma once
+
+#include <display_async_bus.hpp>
+#include <hwlib.hpp>
+#include <st7735_buffered.hpp>
+
+namespace r2d2::display {
+
+    /**
+     * Class st7735_async_buffered is a buffered interface for the st7735
+     * chip that sends the buffer in the background.
+     *
+     * begin_flush() starts sending the changed regions of the buffer and
+     * returns right away. The transfer is moved forward by calling poll()
+     * until is_flushing() returns false. The pixel data is written through
+     * an async_bus_c, the address window of every region is still set
+     * through the normal spi bus.
+     *
+     * Without double buffering the buffer must not be drawn on while it is
+     * being flushed, or the change might only partially reach the screen.
+     * With double buffering the changed regions are copied to a second
+     * buffer when the flush begins, so drawing can continue right away at
+     * the cost of a second buffer.
+     *
+     * When the PixelFormat stores pixels in the byte order of the processor,
+     * the bytes are swapped in bulk where the data leaves the buffer: while
+     * copying to the second buffer, or row by row into a staging row that the
+     * async bus sends from.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam DoubleBuffer Send from a copy of the buffer
+     * @tparam PixelFormat How pixels are converted and stored, see
+     * display_pixel_format.hpp
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, bool DoubleBuffer = false,
+              class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_async_buffered_c
+        : public st7735_buffered_c<DisplayScreen, PixelFormat, BusStats> {
+    protected:
+        // true when a row is swapped into the staging row before it is sent
+        constexpr static bool staged =
+            PixelFormat::native_order && !DoubleBuffer;
+
+        // bus used for writing the pixel data
+        async_bus_c &async_bus;
+
+        // copy of the buffer that is being sent when double buffering
+        uint16_t front[DoubleBuffer ? DisplayScreen::width *
+                                          DisplayScreen::height
+                                    : 1] = {};
+
+        // the row that is being sent when the bytes are swapped row by row
+        uint16_t staging[staged ? DisplayScreen::width : 1] = {};
+
+        // the regions that are being flushed
+        dirty_rectangle_s flush_rectangles[st7735_buffered_c<
+            DisplayScreen, PixelFormat, BusStats>::max_dirty_rectangles] = {};
+        std::size_t flush_count = 0;
+
+        // the region and row that are being sent
+        std::size_t flush_index = 0;
+        uint16_t flush_row = 0;
+
+        bool flushing = false;
+
+        /**
+         * @brief Returns the buffer the data is sent from
+         *
+         */
+        const uint16_t *send_buffer() const {
+            return DoubleBuffer ? front : this->buffer;
+        }
+
+        /**
+         * @brief Sets the address window for the current region
+         *
+         */
+        void begin_rectangle() {
+            const dirty_rectangle_s &rect = flush_rectangles[flush_index];
+
+            st7735_async_buffered_c::set_cursor(rect.x_min, rect.y_min,
+                                                rect.x_max, rect.y_max);
+
+            // write to ram
+            st7735_async_buffered_c::write_command(
+                st7735_async_buffered_c::RAMWR);
+
+            // the pixel data is written by the async bus
+            st7735_async_buffered_c::write_dc(true);
+            flush_row = rect.y_min;
+        }
+
+        /**
+         * @brief Starts writing the next part of the current region. Regions
+         * that are as wide as the screen are written at once, other regions
+         * and swapped rows are written row by row.
+         *
+         */
+        void write_next() {
+            const dirty_rectangle_s &rect = flush_rectangles[flush_index];
+            const std::size_t width = rect.x_max - rect.x_min + 1;
+            const std::size_t rows = width == this->width && !staged
+                                         ? rect.y_max - flush_row + 1
+                                         : 1;
+            const uint16_t *data =
+                &send_buffer()[rect.x_min + (flush_row * this->width)];
+
+            if constexpr (staged) {
+                swap_bytes(data, staging, width);
+                data = staging;
+            }
+
+            this->count_transaction(width * rows * 2);
+            async_bus.begin_write((const uint8_t *)data, width * rows * 2);
+
+            flush_row += rows;
+        }
+
+    public:
+        /**
+         * @brief Construct a new st7735_async_buffered_c object
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         * @param async_bus Bus that writes the pixel data to the screen
+         */
+        st7735_async_buffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                                hwlib::pin_out &dc, hwlib::pin_out &reset,
+                                async_bus_c &async_bus)
+            : st7735_buffered_c<DisplayScreen, PixelFormat, BusStats>(
+                  bus, cs, dc, reset),
+              async_bus(async_bus) {
+        }
+
+        /**
+         * @brief Starts flushing the changed regions of the buffer
+         *
+         * @return false when a flush is still in progress
+         */
+        bool begin_flush() {
+            if (flushing) {
+                return false;
+            }
+
+            this->count_flush();
+
+            flush_count = 0;
+            this->take_dirty([&](const dirty_rectangle_s &rect) {
+                flush_rectangles[flush_count++] = rect;
+
+                // copy the changed region to the buffer that is sent
+                if (DoubleBuffer) {
+                    const std::size_t width = rect.x_max - rect.x_min + 1;
+
+                    for (uint16_t y = rect.y_min; y <= rect.y_max; y++) {
+                        const std::size_t start =
+                            rect.x_min + (y * this->width);
+
+                        if constexpr (PixelFormat::native_order) {
+                            swap_bytes(&this->buffer[start], &front[start],
+                                       width);
+                        } else {
+                            for (std::size_t x = 0; x < width; x++) {
+                                front[start + x] = this->buffer[start + x];
+                            }
+                        }
+                    }
+                }
+            });
+
+            if (flush_count == 0) {
+                return true;
+            }
+
+            flushing = true;
+            flush_index = 0;
+
+            begin_rectangle();
+            write_next();
+
+            return true;
+        }
+
+        /**
+         * @brief Moves the flush forward. Starts the next write when the
+         * previous one is done.
+         *
+         * @return true while the flush is in progress
+         */
+        bool poll() {
+            if (!flushing || !async_bus.poll()) {
+                return flushing;
+            }
+
+            // the last write is done, go to the next region if needed
+            if (flush_row > flush_rectangles[flush_index].y_max) {
+                flush_index++;
+
+                if (flush_index == flush_count) {
+                    flushing = false;
+                    return false;
+                }
+
+                begin_rectangle();
+            }
+
+            write_next();
+            return true;
+        }
+
+        /**
+         * @brief Returns true while a flush is in progress
+         *
+         */
+        bool is_flushing() const {
+            return flushing;
+        }
+
+        /**
+         * @brief Flushes the display and waits until it is done
+         *
+         */
+        void flush() override {
+            // wait for the previous flush
+            while (poll()) {
+            }
+
+            begin_flush();
+
+            while (poll()) {
+            }
+        }
+    };
+
+} // namespace r2d2::display
@@ -0,0 +1,565 @@
+#pragma once
+
+#include <display_fill.hpp>
+#include <display_glyph.hpp>
+#include <hwlib.hpp>
+#include <st7735.hpp>
+
+namespace r2d2::display {
+    /**
+     * The kinds of drawing operations the band renderer records
+     */
+    enum class band_command_type : uint8_t { fill, pixels, character, circle };
+
+    /**
+     * A recorded drawing operation of the band renderer.
+     */
+    struct band_command_s {
+        band_command_type type;
+
+        // the visible part of the operation, after clipping
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+
+        // the position of a character or the midpoint of a circle
+        uint16_t origin_x;
+        uint16_t origin_y;
+
+        // the color of the operation and the background of a character
+        uint16_t data;
+        uint16_t background;
+
+        // the character, the radius of a circle or the offset of the pixels
+        // in the pixel pool
+        uint16_t parameter;
+
+        // a transparent character or a filled circle
+        bool option;
+    };
+
+    /**
+     * Class st7735_band_buffered_c is an interface for the st7735 chip that
+     * sits between the buffered and the unbuffered drivers. Nothing is
+     * written to the screen while drawing: the drawing operations are
+     * recorded, and flush() replays them for every band of BandHeight rows
+     * that changed into a small band buffer. Every band is sent before the
+     * next one is rendered, so the screen gets complete rows without flicker
+     * while only a band of the screen is kept in memory.
+     *
+     * Like a framebuffer, everything that is drawn stays on the screen until
+     * the next clear(). The operations are kept until then, so a band that
+     * changes is rendered again from all operations in it. A flush without
+     * any new operation leaves the screen as it is. Bands that only show the
+     * background and already did are not sent again.
+     *
+     * Every operation costs an entry in the list: a fill, a block of pixels,
+     * a character or a circle. Pixels drawn through hwlib only merge with the
+     * previous pixel when they continue its row in the same color, so every
+     * other run of pixels costs an entry of its own. The pixel data of
+     * set_pixels is copied into a pool of PoolSize pixels.
+     *
+     * The screen is only written by flush(). An operation that doesn't fit
+     * in the list or the pool anymore is not drawn and is counted, see
+     * get_overflows(). The list and the pool are emptied by clear().
+     *
+     * The defaults keep the whole driver below a quarter of the memory of
+     * st7735_buffered_c on the 128x160 screen. Next to the band of 4 KB that
+     * leaves room for 96 operations of 22 bytes and a pool of 256 pixels,
+     * enough for a 16x16 icon.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam BandHeight amount of rows in a band
+     * @tparam MaxCommands amount of operations that can be recorded
+     * @tparam PoolSize amount of pixels of set_pixels that can be recorded
+     * @tparam PixelFormat How pixels are converted and stored, see
+     * display_pixel_format.hpp
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, uint16_t BandHeight = 16,
+              std::size_t MaxCommands = 96, std::size_t PoolSize = 256,
+              class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_band_buffered_c
+        : public st7735_c<DisplayScreen, PixelFormat, BusStats> {
+        static_assert(PoolSize <= UINT16_MAX,
+                      "The offset in the pool has to fit in 16 bits");
+
+    protected:
+        constexpr static uint16_t band_count =
+            (DisplayScreen::height + BandHeight - 1) / BandHeight;
+
+        // the band that is being rendered
+        uint16_t band[DisplayScreen::width * BandHeight] = {};
+        uint16_t band_y = 0;
+        uint16_t band_rows = 0;
+
+        // the recorded operations since the last clear
+        band_command_s commands[MaxCommands] = {};
+        std::size_t command_count = 0;
+
+        // the pixels of the recorded set_pixels operations
+        uint16_t pool[PoolSize] = {};
+        std::size_t pool_used = 0;
+
+        // the background of the frame
+        hwlib::color frame_background = hwlib::black;
+
+        // true when the drawing functions write to the band
+        bool rendering = false;
+
+        // the bands that changed since the last flush
+        bool band_dirty[band_count] = {};
+
+        // the bands that only show the background, and the background they
+        // show
+        bool band_blank[band_count] = {};
+        uint16_t blank_background = 0;
+
+        std::size_t overflows = 0;
+
+        /**
+         * @brief Marks the bands of a range of rows as changed
+         *
+         * @param y
+         * @param height
+         */
+        void mark_dirty(uint16_t y, uint16_t height) {
+            for (uint16_t index = y / BandHeight;
+                 index <= (y + height - 1) / BandHeight; index++) {
+                band_dirty[index] = true;
+            }
+        }
+
+        /**
+         * @brief Adds an operation, an operation that doesn't fit is counted
+         *
+         * @param command
+         */
+        void record(const band_command_s &command) {
+            if (command_count == MaxCommands) {
+                overflows++;
+                return;
+            }
+
+            commands[command_count++] = command;
+            mark_dirty(command.y, command.height);
+        }
+
+        /**
+         * @brief Returns true when an operation has pixels in the band
+         *
+         * @param command
+         */
+        bool in_band(const band_command_s &command) const {
+            return command.y < band_y + band_rows &&
+                   command.y + command.height > band_y;
+        }
+
+        /**
+         * @brief Draws a recorded character in the band, only the rows of the
+         * character inside the band are drawn
+         *
+         * @param command
+         */
+        void render_character(const band_command_s &command) {
+            const uint8_t *glyph = default_glyph(command.parameter);
+            const uint16_t foreground = PixelFormat::to_storage(command.data);
+            const uint16_t background =
+                PixelFormat::to_storage(command.background);
+
+            const uint16_t y_min = command.y > band_y ? command.y : band_y;
+            const uint16_t y_max = command.y + command.height <
+                                           band_y + band_rows
+                                       ? command.y + command.height
+                                       : band_y + band_rows;
+
+            for (uint16_t y = y_min; y < y_max; y++) {
+                const uint8_t row = glyph[y - command.origin_y];
+                uint16_t *destination =
+                    &band[((y - band_y) * DisplayScreen::width) + command.x];
+
+                for (uint16_t x = command.x; x < command.x + command.width;
+                     x++, destination++) {
+                    if (row & (0x80 >> (x - command.origin_x))) {
+                        *destination = foreground;
+                    } else if (!command.option) {
+                        *destination = background;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Draws a recorded operation in the band
+         *
+         * @param command
+         */
+        void render(const band_command_s &command) {
+            const uint16_t y_min = command.y > band_y ? command.y : band_y;
+            const uint16_t y_max = command.y + command.height <
+                                           band_y + band_rows
+                                       ? command.y + command.height
+                                       : band_y + band_rows;
+
+            switch (command.type) {
+                case band_command_type::fill:
+                    buffer_fill_rectangle(
+                        band, DisplayScreen::width, command.x, y_min - band_y,
+                        command.width, y_max - y_min,
+                        PixelFormat::to_storage(command.data));
+                    break;
+                case band_command_type::pixels:
+                    for (uint16_t y = y_min; y < y_max; y++) {
+                        const uint16_t *source =
+                            &pool[command.parameter +
+                                  ((y - command.y) * command.width)];
+                        uint16_t *destination =
+                            &band[((y - band_y) * DisplayScreen::width) +
+                                  command.x];
+
+                        for (uint16_t x = 0; x < command.width; x++) {
+                            destination[x] = PixelFormat::to_storage(source[x]);
+                        }
+                    }
+                    break;
+                case band_command_type::character:
+                    render_character(command);
+                    break;
+                case band_command_type::circle:
+                    // the circle is drawn by display_c, limited to the part
+                    // of the band that it was visible in
+                    this->clip_x_min = command.x;
+                    this->clip_x_max = command.x + command.width;
+                    this->clip_y_min = y_min;
+                    this->clip_y_max = y_max;
+
+                    display_c<DisplayScreen>::set_pixels_circle(
+                        command.origin_x, command.origin_y, command.parameter,
+                        command.option, command.data);
+                    break;
+            }
+        }
+
+    public:
+        /**
+         * @brief Construct a new st7735_band_buffered_c object
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         */
+        st7735_band_buffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                               hwlib::pin_out &dc, hwlib::pin_out &reset)
+            : st7735_c<DisplayScreen, PixelFormat, BusStats>(bus, cs, dc,
+                                                             reset) {
+            // the contents of the screen are unknown after a reset
+            mark_dirty(0, DisplayScreen::height);
+        }
+
+        /**
+         * @brief Returns the amount of operations that didn't fit in the list
+         * or the pool since the start, they are not drawn
+         *
+         * @return std::size_t
+         */
+        std::size_t get_overflows() const {
+            return overflows;
+        }
+
+        /**
+         * @brief Draws a pixel, consecutive pixels of a row are recorded as a
+         * single operation
+         *
+         * @param x
+         * @param y
+         * @param data
+         */
+        void set_pixel(uint16_t x, uint16_t y, const uint16_t data) override {
+            if (rendering) {
+                if (y >= band_y && y < band_y + band_rows) {
+                    band[((y - band_y) * DisplayScreen::width) + x] =
+                        PixelFormat::to_storage(data);
+                }
+                return;
+            }
+
+            // extend the previous pixels of the row
+            if (command_count > 0) {
+                band_command_s &last = commands[command_count - 1];
+
+                if (last.type == band_command_type::fill && last.height == 1 &&
+                    last.y == y && last.data == data &&
+                    last.x + last.width == x) {
+                    last.width++;
+                    mark_dirty(y, 1);
+                    return;
+                }
+            }
+
+            record({band_command_type::fill, x, y, 1, 1, x, y, data, 0, 0,
+                    false});
+        }
+
+        /**
+         * @brief Draws multiple pixels. The visible pixels are copied, so
+         * the data can be changed after the call.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data Data is a pointer to the color of the pixel
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                        const uint16_t *data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            data += rect.offset;
+
+            if (rendering) {
+                for (uint16_t current_height = 0; current_height < rect.height;
+                     current_height++) {
+                    const uint16_t row = rect.y + current_height;
+                    uint16_t *destination =
+                        &band[((row - band_y) * DisplayScreen::width) + rect.x];
+
+                    for (uint16_t current_width = 0;
+                         current_width < rect.width; current_width++) {
+                        destination[current_width] = PixelFormat::to_storage(
+                            data[(current_height * width) + current_width]);
+                    }
+                }
+                return;
+            }
+
+            const std::size_t size = std::size_t(rect.width) * rect.height;
+            if (pool_used + size > PoolSize || command_count == MaxCommands) {
+                overflows++;
+                return;
+            }
+
+            for (uint16_t current_height = 0; current_height < rect.height;
+                 current_height++) {
+                for (uint16_t current_width = 0; current_width < rect.width;
+                     current_width++) {
+                    pool[pool_used + (current_height * rect.width) +
+                         current_width] =
+                        data[(current_height * width) + current_width];
+                }
+            }
+
+            record({band_command_type::pixels, rect.x, rect.y, rect.width,
+                    rect.height, rect.x, rect.y, 0, 0,
+                    static_cast<uint16_t>(pool_used), false});
+            pool_used += size;
+        }
+
+        /**
+         * @brief Fills multiple pixels with the same color
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data Data is the color of all pixels
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                        const uint16_t data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            if (rendering) {
+                buffer_fill_rectangle(band, DisplayScreen::width, rect.x,
+                                      rect.y - band_y, rect.width, rect.height,
+                                      PixelFormat::to_storage(data));
+                return;
+            }
+
+            record({band_command_type::fill, rect.x, rect.y, rect.width,
+                    rect.height, rect.x, rect.y, data, 0, 0, false});
+        }
+
+        /**
+         * @brief Sets character in a single color, the character is recorded
+         * as a single operation
+         *
+         * @param x
+         * @param y
+         * @param character
+         * @param pixel_color
+         */
+        void set_character(uint16_t x, uint16_t y, char character,
+                           uint16_t pixel_color) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, 8, 8, rect)) {
+                return;
+            }
+
+            record({band_command_type::character, rect.x, rect.y, rect.width,
+                    rect.height, x, y, pixel_color,
+                    this->color_to_pixel(this->background),
+                    static_cast<uint8_t>(character),
+                    this->transparent_background});
+        }
+
+        using st7735_c<DisplayScreen, PixelFormat, BusStats>::set_character;
+
+        /**
+         * @brief Draws a circle, the circle is recorded as a single operation
+         *
+         * @param x x-coordinate of the midpoint of the circle
+         * @param y y-coordinate of the midpoint of the circle
+         * @param radius the radius of the circle in pixels
+         * @param filled true for a filled circle, false for the outline
+         * @param data
+         */
+        void set_pixels_circle(uint16_t x, uint16_t y, uint16_t radius,
+                               bool filled, const uint16_t data) override {
+            if (rendering) {
+                display_c<DisplayScreen>::set_pixels_circle(x, y, radius,
+                                                            filled, data);
+                return;
+            }
+
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(int(x) - radius, int(y) - radius,
+                                      (2 * radius) + 1, (2 * radius) + 1,
+                                      rect)) {
+                return;
+            }
+
+            record({band_command_type::circle, rect.x, rect.y, rect.width,
+                    rect.height, x, y, data, 0, radius, filled});
+        }
+
+        using st7735_c<DisplayScreen, PixelFormat, BusStats>::set_pixels_circle;
+
+        /**
+         * @brief Starts a new frame with a background color, all operations
+         * that have been recorded are forgotten. When a clip rectangle is set
+         * only the clip is cleared: the clear is recorded as a fill.
+         *
+         * @param col
+         */
+        void clear(hwlib::color col) override {
+            if (this->clip_x_min != 0 || this->clip_y_min != 0 ||
+                this->clip_x_max != DisplayScreen::width ||
+                this->clip_y_max != DisplayScreen::height) {
+                set_pixels(0, 0, DisplayScreen::width, DisplayScreen::height,
+                           this->color_to_pixel(col));
+                return;
+            }
+
+            command_count = 0;
+            pool_used = 0;
+            frame_background = col;
+            mark_dirty(0, DisplayScreen::height);
+        }
+
+        /**
+         * @brief Starts a new frame with the background color
+         *
+         */
+        void clear() override {
+            clear(this->background);
+        }
+
+        /**
+         * @brief Renders the bands that changed since the last flush and
+         * sends them to the screen, one band at a time
+         *
+         */
+        void flush() override {
+            bool changed = false;
+            for (bool dirty : band_dirty) {
+                changed = changed || dirty;
+            }
+
+            if (!changed) {
+                return;
+            }
+
+            this->count_flush();
+
+            const uint16_t background = this->color_to_pixel(frame_background);
+            if (background != blank_background) {
+                for (bool &blank : band_blank) {
+                    blank = false;
+                }
+                blank_background = background;
+            }
+
+            // the clip rectangle is used for rendering circles
+            const int clip[] = {this->clip_x_min, this->clip_y_min,
+                                this->clip_x_max, this->clip_y_max};
+            rendering = true;
+
+            for (uint16_t index = 0; index < band_count; index++) {
+                if (!band_dirty[index]) {
+                    continue;
+                }
+                band_dirty[index] = false;
+
+                band_y = index * BandHeight;
+                band_rows = DisplayScreen::height - band_y < BandHeight
+                                ? DisplayScreen::height - band_y
+                                : BandHeight;
+
+                bool blank = true;
+                for (std::size_t i = 0; i < command_count && blank; i++) {
+                    blank = !in_band(commands[i]);
+                }
+
+                // the screen already shows the background
+                if (blank && band_blank[index]) {
+                    continue;
+                }
+                band_blank[index] = blank;
+
+                st7735_band_buffered_c::set_cursor(0, band_y, this->width - 1,
+                                                   band_y + band_rows - 1);
+                st7735_band_buffered_c::write_command(
+                    st7735_band_buffered_c::RAMWR);
+
+                if (blank) {
+                    st7735_band_buffered_c::fill_pixels(
+                        background, std::size_t(this->width) * band_rows);
+                    continue;
+                }
+
+                buffer_fill(band, PixelFormat::to_storage(background),
+                            std::size_t(this->width) * band_rows);
+
+                for (std::size_t i = 0; i < command_count; i++) {
+                    if (in_band(commands[i])) {
+                        render(commands[i]);
+                    }
+                }
+
+                if constexpr (PixelFormat::native_order) {
+                    st7735_band_buffered_c::write_pixels(
+                        band, std::size_t(this->width) * band_rows);
+                } else {
+                    st7735_band_buffered_c::write_data(
+                        (uint8_t *)band,
+                        std::size_t(this->width) * band_rows * 2);
+                }
+            }
+
+            rendering = false;
+            this->clip_x_min = clip[0];
+            this->clip_y_min = clip[1];
+            this->clip_x_max = clip[2];
+            this->clip_y_max = clip[3];
+        }
+    };
+
+} // namespace r2d2::display
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <display_fill.hpp>
 #include <hwlib.hpp>
-#include <st7735.hpp>
+#include <st7735_dirty_tracking.hpp>
 #include <type_traits>
 
 namespace r2d2::display {
@@ -10,12 +11,18 @@ namespace r2d2::display {
      * Class st7735_buffered is an interface for the st7735 chip
      *
      * Implements hwlib::window to easily use text and drawing functions that
-     * are already implemented. Extends from r2d2::display::st7735_c
+     * are already implemented. Extends from
+     * r2d2::display::st7735_dirty_tracking_c
      *
-     * The template paramters are required for the parent class
+     * The template paramters are required for the parent class. When the
+     * PixelFormat stores pixels in the byte order of the processor, drawing
+     * doesn't swap any bytes and the changed regions are swapped in bulk
+     * when they are flushed.
      */
-    template <class DisplayScreen>
-    class st7735_buffered_c : public st7735_c<DisplayScreen> {
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_buffered_c
+        : public st7735_dirty_tracking_c<DisplayScreen, PixelFormat, BusStats> {
     protected:
         uint16_t buffer[DisplayScreen::width * DisplayScreen::height] = {};
 
@@ -30,7 +37,7 @@ namespace r2d2::display {
          */
         st7735_buffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
                           hwlib::pin_out &dc, hwlib::pin_out &reset)
-            : st7735_c<DisplayScreen>(
+            : st7735_dirty_tracking_c<DisplayScreen, PixelFormat, BusStats>(
                   bus, cs, dc, reset) {
         }
 
@@ -44,7 +51,9 @@ namespace r2d2::display {
         void set_pixel(uint16_t x, uint16_t y, const uint16_t data) override {
 
             // write pixel data to the buffer
-            this->buffer[x + (y * this->width)] = __REV16(data); 
+            this->buffer[x + (y * this->width)] = PixelFormat::to_storage(data);
+
+            this->mark_dirty(x, y, 1, 1);
 
         }
 
@@ -61,15 +70,22 @@ namespace r2d2::display {
          */
         void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
                         const uint16_t *data) override {
-            // unfortunaly the arduino due is little endian otherwise we could
-            // put all the data directly to the buffer
-            for (std::size_t current_height = 0; current_height < height; current_height++) {
-                for (std::size_t current_width = 0; current_width < width; current_width++) {
-                    const uint16_t inverted_data = __REV16(data[(current_height * width) + current_width]);
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            data += rect.offset;
 
-                    buffer[(x + current_width) + ((y + current_height) * this->width)] = inverted_data;
+            // convert the data to the byte order of the buffer
+            for (std::size_t current_height = 0; current_height < rect.height; current_height++) {
+                for (std::size_t current_width = 0; current_width < rect.width; current_width++) {
+                    buffer[(rect.x + current_width) + ((rect.y + current_height) * this->width)] =
+                        PixelFormat::to_storage(data[(current_height * width) + current_width]);
                 }
             }
+
+            this->mark_dirty(rect.x, rect.y, rect.width, rect.height);
         }
 
         /**
@@ -84,31 +100,68 @@ namespace r2d2::display {
          */
         void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
                         const uint16_t data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
 
-            // make a copy and reverse byte order
-            uint16_t inverted_data = __REV16(data); 
+            // convert the data to the byte order of the buffer
+            buffer_fill_rectangle(buffer, this->width, rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  PixelFormat::to_storage(data));
 
-            for (std::size_t current_height = 0; current_height < height; current_height++) {
-                for (std::size_t current_width = 0; current_width < width; current_width++) {
-                    buffer[(x + current_width) + ((y + current_height) * this->width)] = inverted_data;
-                }
-            }
+            this->mark_dirty(rect.x, rect.y, rect.width, rect.height);
         }
 
         /**
-         * @brief Flushes the display
+         * @brief Clears the display with a color. This overrides the default
+         * clear of hwlib because it writes a pixel at a time. Like every
+         * other drawing function it only clears the clip rectangle.
          *
+         * @param col
          */
-        void flush() override {
-            st7735_buffered_c::set_cursor(0, 0, this->width - 1,
-                                          this->height - 1);
+        void clear(hwlib::color col) override {
+            set_pixels(0, 0, this->width, this->height,
+                       this->color_to_pixel(col));
+        }
 
-            // write to ram
-            st7735_buffered_c::write_command(st7735_buffered_c::RAMWR);
+        /**
+         * @brief Clears the display with the background color
+         *
+         */
+        void clear() override {
+            clear(this->background);
+        }
 
-            // write data to display
-            st7735_buffered_c::write_data((uint8_t *)buffer,
-                                          this->width * this->height * 2);
+        /**
+         * @brief Flushes the display. Only the regions that changed since
+         * the last flush are sent, every region gets its own address window.
+         * In partial mode only the changes inside the partial area are sent.
+         *
+         */
+        void flush() override {
+            this->count_flush();
+
+            this->take_dirty([&](const dirty_rectangle_s &rect) {
+                st7735_buffered_c::set_cursor(rect.x_min, rect.y_min,
+                                              rect.x_max, rect.y_max);
+
+                // write to ram
+                st7735_buffered_c::write_command(st7735_buffered_c::RAMWR);
+
+                // write every row of the region to the display
+                if constexpr (PixelFormat::native_order) {
+                    st7735_buffered_c::write_pixels(
+                        &buffer[rect.x_min + (rect.y_min * this->width)],
+                        rect.x_max - rect.x_min + 1, this->width,
+                        rect.y_max - rect.y_min + 1);
+                } else {
+                    st7735_buffered_c::write_data_rows(
+                        (uint8_t *)&buffer[rect.x_min + (rect.y_min * this->width)],
+                        (rect.x_max - rect.x_min + 1) * 2, this->width * 2,
+                        rect.y_max - rect.y_min + 1);
+                }
+            });
         }
     };
 
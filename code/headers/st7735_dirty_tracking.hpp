@@ -0,0 +1,95 @@
+#pragma once
+
+#include <display_dirty_region.hpp>
+#include <display_pixel_format.hpp>
+#include <hwlib.hpp>
+#include <st7735.hpp>
+
+namespace r2d2::display {
+
+    /**
+     * Class st7735_dirty_tracking_c keeps track of the regions of a st7735
+     * framebuffer that changed since the last flush. It is the base of the
+     * buffered drivers, which only differ in how they store and send their
+     * pixels.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam PixelFormat Converts the colors, see display_pixel_format.hpp
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_dirty_tracking_c
+        : public st7735_c<DisplayScreen, PixelFormat, BusStats> {
+    protected:
+        // the overhead of CASET, RASET and RAMWR expressed in pixels
+        constexpr static uint32_t window_cost = 32;
+
+        // the maximum amount of regions that are flushed separately
+        constexpr static std::size_t max_dirty_rectangles = 8;
+
+        // the regions of the buffer that changed since the last flush
+        dirty_region_c<max_dirty_rectangles, window_cost> dirty;
+
+        /**
+         * @brief Mark a rectangle of the buffer as changed
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         */
+        void mark_dirty(uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height) {
+            if (width == 0 || height == 0 || x >= this->width ||
+                y >= this->height) {
+                return;
+            }
+
+            // a window can never be bigger than the screen
+            if (x + width > this->width) {
+                width = this->width - x;
+            }
+            if (y + height > this->height) {
+                height = this->height - y;
+            }
+
+            dirty.add(x, y, x + width - 1, y + height - 1);
+        }
+
+        /**
+         * @brief Calls send for every changed region of the buffer and
+         * forgets them. In partial mode only the part of a region inside the
+         * partial area is sent, the rest stays changed until the normal mode
+         * is set again.
+         *
+         * @param send
+         */
+        template <class Send>
+        void take_dirty(Send &&send) {
+            if (this->partial) {
+                dirty.take(this->partial_y_min, this->partial_y_max, send);
+            } else {
+                dirty.take(0, this->height - 1, send);
+            }
+        }
+
+        /**
+         * @brief Construct a new st7735_dirty_tracking_c object, the whole
+         * screen is marked as changed
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         */
+        st7735_dirty_tracking_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                                hwlib::pin_out &dc, hwlib::pin_out &reset)
+            : st7735_c<DisplayScreen, PixelFormat, BusStats>(bus, cs, dc,
+                                                             reset) {
+            // the contents of the screen are unknown after a reset
+            mark_dirty(0, 0, this->width, this->height);
+        }
+    };
+
+} // namespace r2d2::display
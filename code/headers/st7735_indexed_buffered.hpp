@@ -0,0 +1,417 @@
+#pragma once
+
+#include <cstring>
+#include <display_pixel_format.hpp>
+#include <hwlib.hpp>
+#include <st7735_dirty_tracking.hpp>
+
+namespace r2d2::display {
+
+    /**
+     * Class st7735_indexed_buffered_c is a buffered interface for the st7735
+     * chip that stores a palette index for every pixel instead of a RGB565
+     * color. With 8, 4 or 2 bits per pixel the buffer of a 128x160 screen
+     * is 20 KB, 10 KB or 5 KB instead of 40 KB.
+     *
+     * The pixel data of the drawing functions is a palette index,
+     * color_to_pixel returns the index of the closest color in the palette.
+     * The indexes are expanded to RGB565 through the palette while the buffer
+     * is flushed. The palette can be changed at any time: the next flush
+     * recolours the whole screen without drawing anything again.
+     *
+     * The default palette is RGB332 for 8 bits, the 16 VGA colors for 4 bits
+     * and 4 shades of gray for 2 bits. Black is always the first and white
+     * the last color.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam BitsPerPixel 8, 4 or 2
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, uint8_t BitsPerPixel = 4,
+              class BusStats = no_bus_stats_c>
+    class st7735_indexed_buffered_c
+        : public st7735_dirty_tracking_c<DisplayScreen, rgb565_big_endian_s,
+                                         BusStats> {
+        static_assert(BitsPerPixel == 8 || BitsPerPixel == 4 ||
+                          BitsPerPixel == 2,
+                      "Only 8, 4 and 2 bits per pixel are supported");
+
+    public:
+        /**
+         * @brief amount of colors in the palette
+         *
+         */
+        constexpr static uint16_t palette_size = 1 << BitsPerPixel;
+
+        /**
+         * @brief Returns a color of the default palette as RGB565
+         *
+         * @param index
+         * @return constexpr uint16_t
+         */
+        constexpr static uint16_t default_palette_color(uint8_t index) {
+            if constexpr (BitsPerPixel == 8) {
+                return rgb332_to_rgb565(index);
+            } else if constexpr (BitsPerPixel == 4) {
+                constexpr hwlib::color colors[] = {
+                    hwlib::color(0, 0, 0),       hwlib::color(0, 0, 170),
+                    hwlib::color(0, 170, 0),     hwlib::color(0, 170, 170),
+                    hwlib::color(170, 0, 0),     hwlib::color(170, 0, 170),
+                    hwlib::color(170, 85, 0),    hwlib::color(170, 170, 170),
+                    hwlib::color(85, 85, 85),    hwlib::color(85, 85, 255),
+                    hwlib::color(85, 255, 85),   hwlib::color(85, 255, 255),
+                    hwlib::color(255, 85, 85),   hwlib::color(255, 85, 255),
+                    hwlib::color(255, 255, 85),  hwlib::color(255, 255, 255)};
+
+                return color_to_rgb565(colors[index & (palette_size - 1)]);
+            } else {
+                const uint8_t level = (index & (palette_size - 1)) * 85;
+
+                return color_to_rgb565(hwlib::color(level, level, level));
+            }
+        }
+
+    protected:
+        constexpr static uint8_t pixels_per_byte = 8 / BitsPerPixel;
+        constexpr static uint8_t index_mask = palette_size - 1;
+
+        // amount of bytes of every row of the buffer
+        constexpr static std::size_t stride =
+            (DisplayScreen::width + pixels_per_byte - 1) / pixels_per_byte;
+
+        // the palette indexes, the first pixel of a byte is in the most
+        // significant bits
+        uint8_t buffer[stride * DisplayScreen::height] = {};
+
+        // the colors of the palette in the byte order of the screen
+        uint16_t palette[palette_size] = {};
+
+        /**
+         * @brief Returns a byte that holds the same index for every pixel
+         *
+         * @param index
+         */
+        constexpr static uint8_t repeat_index(uint8_t index) {
+            unsigned int byte = 0;
+            for (uint8_t i = 0; i < pixels_per_byte; i++) {
+                byte = (byte << BitsPerPixel) | (index & index_mask);
+            }
+
+            return static_cast<uint8_t>(byte);
+        }
+
+        /**
+         * @brief Write the palette index of a pixel to the buffer
+         *
+         * @param x
+         * @param y
+         * @param index
+         */
+        void write_index(uint16_t x, uint16_t y, uint8_t index) {
+            uint8_t &byte = buffer[(x / pixels_per_byte) + (y * stride)];
+            const uint8_t shift =
+                (pixels_per_byte - 1 - (x % pixels_per_byte)) * BitsPerPixel;
+
+            byte = static_cast<uint8_t>((byte & ~(index_mask << shift)) |
+                                        ((index & index_mask) << shift));
+        }
+
+        /**
+         * @brief Fill a run of pixels in a row of the buffer with the same
+         * index. The whole bytes of the run are filled at once.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param index
+         */
+        void fill_row(uint16_t x, uint16_t y, uint16_t width, uint8_t index) {
+            const uint16_t end = x + width;
+
+            // the pixels before the first whole byte
+            for (; x < end && (x % pixels_per_byte) != 0; x++) {
+                write_index(x, y, index);
+            }
+
+            const uint16_t bytes = (end - x) / pixels_per_byte;
+            std::memset(&buffer[(x / pixels_per_byte) + (y * stride)],
+                        repeat_index(index), bytes);
+            x += bytes * pixels_per_byte;
+
+            // the pixels after the last whole byte
+            for (; x < end; x++) {
+                write_index(x, y, index);
+            }
+        }
+
+        /**
+         * @brief Expands a run of pixels of a row of the buffer to colors in
+         * the byte order of the screen. Whole bytes of the buffer are
+         * expanded at once.
+         *
+         * @param x
+         * @param y
+         * @param count amount of pixels
+         * @param destination
+         */
+        void expand_row(uint16_t x, uint16_t y, std::size_t count,
+                        uint16_t *destination) const {
+            const uint8_t *row = &buffer[y * stride];
+            const uint16_t end = x + count;
+
+            auto index_at = [&](uint16_t column) {
+                const uint8_t shift =
+                    (pixels_per_byte - 1 - (column % pixels_per_byte)) *
+                    BitsPerPixel;
+
+                return (row[column / pixels_per_byte] >> shift) & index_mask;
+            };
+
+            // the pixels before the first whole byte
+            for (; x < end && (x % pixels_per_byte) != 0; x++) {
+                *destination++ = palette[index_at(x)];
+            }
+
+            for (; x + pixels_per_byte <= end; x += pixels_per_byte) {
+                const uint8_t byte = row[x / pixels_per_byte];
+
+                for (uint8_t i = 0; i < pixels_per_byte; i++) {
+                    *destination++ =
+                        palette[(byte >> ((pixels_per_byte - 1 - i) *
+                                          BitsPerPixel)) &
+                                index_mask];
+                }
+            }
+
+            // the pixels after the last whole byte
+            for (; x < end; x++) {
+                *destination++ = palette[index_at(x)];
+            }
+        }
+
+        /**
+         * @brief Write a region of the buffer to the screen in a single
+         * transaction. The indexes are expanded to colors through the
+         * palette in a small staging buffer, which is written to the bus
+         * every time it is full.
+         *
+         * @param rect
+         */
+        void write_indexed_pixels(const dirty_rectangle_s &rect) {
+            uint16_t staging[this->staging_size];
+            std::size_t staged = 0;
+
+            const std::size_t width = rect.x_max - rect.x_min + 1;
+            const std::size_t rows = rect.y_max - rect.y_min + 1;
+
+            // set display in data mode
+            this->write_dc(true);
+            this->count_transaction(width * rows * 2);
+
+            auto transaction = this->bus.transaction(this->cs);
+            for (uint16_t y = rect.y_min; y <= rect.y_max; y++) {
+                std::size_t x = 0;
+
+                while (x < width) {
+                    const std::size_t chunk =
+                        width - x < this->staging_size - staged
+                            ? width - x
+                            : this->staging_size - staged;
+
+                    expand_row(rect.x_min + x, y, chunk, &staging[staged]);
+                    staged += chunk;
+                    x += chunk;
+
+                    if (staged == this->staging_size) {
+                        transaction.write(staged * 2, (uint8_t *)staging);
+                        staged = 0;
+                    }
+                }
+            }
+
+            if (staged > 0) {
+                transaction.write(staged * 2, (uint8_t *)staging);
+            }
+        }
+
+    public:
+        /**
+         * @brief Construct a new st7735_indexed_buffered_c object
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         */
+        st7735_indexed_buffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                                  hwlib::pin_out &dc, hwlib::pin_out &reset)
+            : st7735_dirty_tracking_c<DisplayScreen, rgb565_big_endian_s,
+                                      BusStats>(bus, cs, dc, reset) {
+            for (uint16_t i = 0; i < palette_size; i++) {
+                palette[i] = swap_bytes(default_palette_color(i));
+            }
+        }
+
+        /**
+         * @brief Changes a color of the palette. All pixels with the index
+         * get the new color on the next flush.
+         *
+         * @param index
+         * @param col
+         */
+        void set_palette_color(uint8_t index, hwlib::color col) {
+            const uint16_t color = swap_bytes(color_to_rgb565(col));
+
+            if (palette[index & index_mask] == color) {
+                return;
+            }
+
+            palette[index & index_mask] = color;
+            this->mark_dirty(0, 0, this->width, this->height);
+        }
+
+        /**
+         * @brief Returns the index of the color in the palette that is the
+         * closest to a hwlib::color
+         *
+         * @param col
+         * @return uint16_t
+         */
+        uint16_t color_to_pixel(hwlib::color col) override {
+            const uint16_t color = color_to_rgb565(col);
+
+            uint8_t closest = 0;
+            uint32_t closest_distance = UINT32_MAX;
+
+            for (uint16_t i = 0; i < palette_size; i++) {
+                const uint16_t entry = swap_bytes(palette[i]);
+                if (entry == color) {
+                    return i;
+                }
+
+                // the distance of the components, green has an extra bit
+                const int red = int(entry >> 11) - int(color >> 11);
+                const int green =
+                    int((entry >> 5) & 0x3F) - int((color >> 5) & 0x3F);
+                const int blue = int(entry & 0x1F) - int(color & 0x1F);
+                const uint32_t distance = uint32_t(
+                    (4 * red * red) + (green * green) + (4 * blue * blue));
+
+                if (distance < closest_distance) {
+                    closest = i;
+                    closest_distance = distance;
+                }
+            }
+
+            return closest;
+        }
+
+        /**
+         * @brief Directly write a pixel to the buffer
+         *
+         * @param x
+         * @param y
+         * @param data The palette index of the pixel
+         */
+        void set_pixel(uint16_t x, uint16_t y, const uint16_t data) override {
+            write_index(x, y, data);
+            this->mark_dirty(x, y, 1, 1);
+        }
+
+        /**
+         * @brief Directly write multiple pixels to the buffer. This
+         * effectively draws a rectangle based on given location and size.
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data Data is a pointer to the palette indexes of the pixels
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                        const uint16_t *data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            data += rect.offset;
+
+            for (uint16_t current_height = 0; current_height < rect.height;
+                 current_height++) {
+                for (uint16_t current_width = 0; current_width < rect.width;
+                     current_width++) {
+                    write_index(rect.x + current_width, rect.y + current_height,
+                                data[(current_height * width) + current_width]);
+                }
+            }
+
+            this->mark_dirty(rect.x, rect.y, rect.width, rect.height);
+        }
+
+        /**
+         * @brief Directly fill multiple pixels with the same palette index
+         *
+         * @param x
+         * @param y
+         * @param width
+         * @param height
+         * @param data Data is the palette index of all pixels
+         */
+        void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                        const uint16_t data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            for (uint16_t current_height = 0; current_height < rect.height;
+                 current_height++) {
+                fill_row(rect.x, rect.y + current_height, rect.width, data);
+            }
+
+            this->mark_dirty(rect.x, rect.y, rect.width, rect.height);
+        }
+
+        /**
+         * @brief Clears the display with a color. This overrides the default
+         * clear of hwlib because it writes a pixel at a time. Like every
+         * other drawing function it only clears the clip rectangle.
+         *
+         * @param col
+         */
+        void clear(hwlib::color col) override {
+            set_pixels(0, 0, this->width, this->height, color_to_pixel(col));
+        }
+
+        /**
+         * @brief Clears the display with the background color
+         *
+         */
+        void clear() override {
+            clear(this->background);
+        }
+
+        /**
+         * @brief Flushes the display. Only the regions that changed since
+         * the last flush are sent, every region gets its own address window.
+         * In partial mode only the changes inside the partial area are sent.
+         *
+         */
+        void flush() override {
+            this->count_flush();
+
+            this->take_dirty([&](const dirty_rectangle_s &rect) {
+                st7735_indexed_buffered_c::set_cursor(rect.x_min, rect.y_min,
+                                                      rect.x_max, rect.y_max);
+
+                // write to ram
+                st7735_indexed_buffered_c::write_command(
+                    st7735_indexed_buffered_c::RAMWR);
+
+                write_indexed_pixels(rect);
+            });
+        }
+    };
+
+} // namespace r2d2::display
@@ -16,9 +16,10 @@ namespace r2d2::display {
      *
      * The template paramters are required for the parent class
      */
-    template <class DisplayScreen>
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
     class st7735_inverted_color_buffered_c
-        : public st7735_buffered_c<DisplayScreen> {
+        : public st7735_buffered_c<DisplayScreen, PixelFormat, BusStats> {
     public:
         /**
          * @brief Construct a new st7735_unbuffered_c object
@@ -31,10 +32,13 @@ namespace r2d2::display {
         st7735_inverted_color_buffered_c(hwlib::spi_bus &bus,
                                          hwlib::pin_out &cs, hwlib::pin_out &dc,
                                          hwlib::pin_out &reset)
-            : st7735_buffered_c<DisplayScreen>(bus, cs, dc, reset) {
+            : st7735_buffered_c<DisplayScreen, PixelFormat, BusStats>(
+                  bus, cs, dc, reset) {
             // display inversion on, memory direction control
             this->init();
-            this->write_command(st7735_c<DisplayScreen>::INVON, st7735_c<DisplayScreen>::MADCTL);
+            this->write_command(
+                st7735_c<DisplayScreen, PixelFormat, BusStats>::INVON,
+                st7735_c<DisplayScreen, PixelFormat, BusStats>::MADCTL);
             this->write_data(0xC8);
             hwlib::wait_ms(20);
         }
@@ -16,9 +16,10 @@ namespace r2d2::display {
      *
      * The template paramters are required for the parent class
      */
-    template <class DisplayScreen>
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
     class st7735_inverted_color_unbuffered_c
-        : public st7735_unbuffered_c<DisplayScreen> {
+        : public st7735_unbuffered_c<DisplayScreen, PixelFormat, BusStats> {
     public:
         /**
          * @brief Construct a new st7735_unbuffered_c object
@@ -32,7 +33,8 @@ namespace r2d2::display {
                                            hwlib::pin_out &cs,
                                            hwlib::pin_out &dc,
                                            hwlib::pin_out &reset)
-            : st7735_unbuffered_c<DisplayScreen>(bus, cs, dc, reset) {
+            : st7735_unbuffered_c<DisplayScreen, PixelFormat, BusStats>(
+                  bus, cs, dc, reset) {
             // display inversion on, memory direction control
             this->init();
             this->write_command(this->INVON, this->MADCTL);
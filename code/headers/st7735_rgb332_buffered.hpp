@@ -0,0 +1,51 @@
+#pragma once
+
+#include <display_pixel_format.hpp>
+#include <hwlib.hpp>
+#include <st7735_indexed_buffered.hpp>
+
+namespace r2d2::display {
+
+    /**
+     * Class st7735_rgb332_buffered_c is a buffered interface for the st7735
+     * chip that stores every pixel as RGB332 in a single byte, half the
+     * memory of a RGB565 buffer.
+     *
+     * The pixel data of the drawing functions is a RGB332 color, which is
+     * expanded to RGB565 while the buffer is flushed. The palette of
+     * st7735_indexed_buffered_c can still be changed, for example to fade
+     * the screen.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam BusStats Counts the bus traffic, see display_bus_stats.hpp
+     */
+    template <class DisplayScreen, class BusStats = no_bus_stats_c>
+    class st7735_rgb332_buffered_c
+        : public st7735_indexed_buffered_c<DisplayScreen, 8, BusStats> {
+    public:
+        /**
+         * @brief Construct a new st7735_rgb332_buffered_c object
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         */
+        st7735_rgb332_buffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                                 hwlib::pin_out &dc, hwlib::pin_out &reset)
+            : st7735_indexed_buffered_c<DisplayScreen, 8, BusStats>(bus, cs, dc,
+                                                          reset) {
+        }
+
+        /**
+         * @brief Converts a hwlib::color to RGB332
+         *
+         * @param col
+         * @return uint16_t
+         */
+        uint16_t color_to_pixel(hwlib::color col) override {
+            return color_to_rgb332(col);
+        }
+    };
+
+} // namespace r2d2::display
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <hwlib.hpp>
+#include <st7735.hpp>
+
+namespace r2d2::display {
+    /**
+     * Class st7735_terminal_c is a scrolling text terminal on top of a st7735
+     * driver, for log-style screens. Works with the buffered and the
+     * unbuffered drivers.
+     *
+     * Every 8 rows of the screen are a line of the terminal. When the
+     * terminal is full, a new line is written over the oldest line and the
+     * scroll start address of the display moves one line down, so the
+     * display scrolls the screen instead of the driver. Only the row of the
+     * new line is sent.
+     *
+     * The rows of the driver are the rows of the display memory: after the
+     * terminal scrolled, the top line of the screen is at line top_line()
+     * of the driver. For the buffered drivers the buffer is used as a ring of
+     * lines in the same way. clear() scrolls the screen back.
+     *
+     * @tparam Driver A st7735 driver, like st7735_buffered_c or
+     * st7735_unbuffered_c
+     */
+    template <class Driver>
+    class st7735_terminal_c : public Driver {
+    protected:
+        constexpr static uint8_t line_height = 8;
+
+        /// The amount of lines on the screen
+        constexpr static uint8_t lines = Driver::height / line_height;
+
+        /// The line of the driver that is shown at the top of the screen
+        uint8_t top = 0;
+
+        /// The amount of lines on the terminal
+        uint8_t line_count = 0;
+
+        /// True when the screen has to scroll once the new line is sent
+        bool scroll_pending = false;
+
+        /**
+         * @brief Returns the row of the next line of the terminal, scrolls
+         * the screen when the terminal is full
+         */
+        uint16_t next_line() {
+            uint8_t line;
+
+            if (line_count < lines) {
+                line = (top + line_count) % lines;
+                line_count++;
+            } else {
+                // the oldest line is replaced and becomes the bottom line
+                line = top;
+                top = (top + 1) % lines;
+                scroll_pending = true;
+            }
+
+            const uint16_t y = line * line_height;
+
+            // characters with a transparent background don't clear the line
+            if (this->transparent_background) {
+                this->set_pixels(0, y, Driver::width, line_height,
+                                 this->color_to_pixel(this->background));
+            }
+
+            return y;
+        }
+
+        /**
+         * @brief Clears the rest of a line after the characters and sends
+         * the line to the display. The screen scrolls after the line has
+         * been sent, so the old line is never shown at the bottom.
+         *
+         * @param y
+         * @param count amount of characters on the line
+         */
+        void end_line(uint16_t y, std::size_t count) {
+            const uint16_t x = count * 8;
+
+            if (!this->transparent_background && x < Driver::width) {
+                this->set_pixels(x, y, Driver::width - x, line_height,
+                                 this->color_to_pixel(this->background));
+            }
+
+            this->flush();
+
+            if (scroll_pending) {
+                this->set_scroll_start(top * line_height);
+                scroll_pending = false;
+            }
+        }
+
+    public:
+        /**
+         * @brief Construct a new st7735_terminal_c object
+         *
+         * @param bus
+         * @param cs
+         * @param dc
+         * @param reset
+         */
+        st7735_terminal_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
+                          hwlib::pin_out &dc, hwlib::pin_out &reset)
+            : Driver(bus, cs, dc, reset) {
+            this->set_scroll_area(0, lines * line_height);
+            this->set_scroll_start(0);
+        }
+
+        /**
+         * @brief Returns the line of the driver that is shown at the top of
+         * the screen
+         */
+        uint8_t top_line() const {
+            return top;
+        }
+
+        /**
+         * @brief Writes a line below the last line of the terminal in the
+         * foreground color and sends it to the display. When the terminal is
+         * full the screen scrolls up by one line. Characters that don't fit
+         * on the line are dropped.
+         *
+         * @param characters
+         */
+        void write_line(const char *characters) {
+            const uint16_t y = next_line();
+            const std::size_t count = this->characters_in_row(0, characters);
+
+            this->set_characters(0, y, characters, count,
+                                 this->color_to_pixel(this->foreground));
+
+            end_line(y, count);
+        }
+
+        /**
+         * @brief Writes a line below the last line of the terminal with a
+         * cursor. The cursor is moved to the new line first and is left
+         * behind the last character, so more characters can be added to the
+         * line with set_character.
+         *
+         * @param cursor_target This targets the cursor with which to draw
+         * @param characters
+         */
+        void write_line(uint8_t cursor_target, const char *characters) {
+            const uint16_t y = next_line();
+
+            this->set_cursor_position(cursor_target, 0, y);
+            this->set_character(cursor_target, characters);
+
+            end_line(y, this->characters_in_row(0, characters));
+        }
+
+        /**
+         * @brief Clears the display and the lines of the terminal, a scrolled
+         * screen is scrolled back to the first line
+         *
+         * @param col
+         */
+        void clear(hwlib::color col) override {
+            Driver::clear(col);
+
+            line_count = 0;
+
+            if (top != 0) {
+                top = 0;
+                this->set_scroll_start(0);
+            }
+        }
+
+        /**
+         * @brief Clears the display with the background color
+         *
+         */
+        void clear() override {
+            clear(this->background);
+        }
+    };
+
+} // namespace r2d2::display
@@ -13,8 +13,10 @@ namespace r2d2::display {
      *
      * The template paramters are required for the parent class
      */
-    template <class DisplayScreen>
-    class st7735_unbuffered_c : public st7735_c<DisplayScreen> {
+    template <class DisplayScreen, class PixelFormat = rgb565_big_endian_s,
+              class BusStats = no_bus_stats_c>
+    class st7735_unbuffered_c
+        : public st7735_c<DisplayScreen, PixelFormat, BusStats> {
     public:
         /**
          * @brief Construct a new st7735_unbuffered_c object
@@ -26,7 +28,87 @@ namespace r2d2::display {
          */
         st7735_unbuffered_c(hwlib::spi_bus &bus, hwlib::pin_out &cs,
                             hwlib::pin_out &dc, hwlib::pin_out &reset)
-            : st7735_c<DisplayScreen>(bus, cs, dc, reset) {
+            : st7735_c<DisplayScreen, PixelFormat, BusStats>(bus, cs, dc,
+                                                             reset) {
+        }
+
+        /**
+         * @brief Draws characters on a single row with a single address
+         * window. Every glyph row is expanded into the staging buffer, which
+         * is written to the bus every time it is full.
+         *
+         * @param x
+         * @param y
+         * @param characters
+         * @param count
+         * @param pixel_color
+         */
+        void set_characters(uint16_t x, uint16_t y, const char *characters,
+                            std::size_t count,
+                            uint16_t pixel_color) override {
+            // without a background only the character pixels can be written
+            if (this->transparent_background) {
+                st7735_c<DisplayScreen, PixelFormat, BusStats>::set_characters(
+                    x, y, characters, count, pixel_color);
+                return;
+            }
+
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, count * 8, 8, rect)) {
+                return;
+            }
+
+            st7735_unbuffered_c::set_cursor(rect.x, rect.y,
+                                            rect.x + rect.width - 1,
+                                            rect.y + rect.height - 1);
+
+            // write to ram
+            st7735_unbuffered_c::write_command(st7735_unbuffered_c::RAMWR);
+
+            // the pixels are expanded in the byte order of the screen
+            const uint16_t foreground = swap_bytes(pixel_color);
+            const uint16_t background =
+                swap_bytes(this->color_to_pixel(this->background));
+
+            // the visible part of the characters
+            const uint16_t column_min = rect.x - x;
+            const uint16_t column_max = column_min + rect.width;
+            const uint16_t row_min = rect.y - y;
+            const uint16_t row_max = row_min + rect.height;
+
+            uint16_t staging[this->staging_size];
+            std::size_t staged = 0;
+
+            // set display in data mode
+            this->write_dc(true);
+            this->count_transaction(std::size_t(rect.width) * rect.height * 2);
+
+            auto transaction = this->bus.transaction(this->cs);
+            for (uint16_t row = row_min; row < row_max; row++) {
+                uint16_t column = column_min;
+
+                while (column < column_max) {
+                    uint16_t pixels[8];
+                    expand_glyph_row(
+                        default_glyph(characters[column / 8])[row],
+                        foreground, background, pixels);
+
+                    // the visible pixels of this character
+                    for (uint16_t i = column % 8;
+                         i < 8 && column < column_max; i++, column++) {
+                        staging[staged++] = pixels[i];
+
+                        if (staged == this->staging_size) {
+                            transaction.write(staged * 2, (uint8_t *)staging);
+                            staged = 0;
+                        }
+                    }
+                }
+            }
+
+            if (staged > 0) {
+                transaction.write(staged * 2, (uint8_t *)staging);
+            }
         }
 
         /**
@@ -44,7 +126,7 @@ namespace r2d2::display {
             st7735_unbuffered_c::write_command(st7735_unbuffered_c::RAMWR);
 
             // make a copy and reverse byte order
-            const uint16_t inverted_data = __REV16(data); 
+            const uint16_t inverted_data = swap_bytes(data); 
 
             // write pixel data to the screeen
             st7735_unbuffered_c::write_data((uint8_t *)&inverted_data, 2);
@@ -61,19 +143,22 @@ namespace r2d2::display {
          */
         void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
                         const uint16_t *data) override {
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
             // set the window to the size we want to write to
-            st7735_unbuffered_c::set_cursor(x, y, x + width, y + height);
+            st7735_unbuffered_c::set_cursor(rect.x, rect.y,
+                                            rect.x + rect.width - 1,
+                                            rect.y + rect.height - 1);
 
             // write to ram
             st7735_unbuffered_c::write_command(st7735_unbuffered_c::RAMWR);
 
-            // unfortunaly the arduino due is little endian otherwise we could
-            // put all the data directly to the write_data function
-            for (std::size_t i = 0; i < width * height; i++) {
-                const uint16_t inverted_data = __REV16(data[i]);
-
-                st7735_unbuffered_c::write_data((uint8_t *)&inverted_data, 2);
-            }
+            // stream all visible pixels in a single transaction
+            st7735_unbuffered_c::write_pixels(data + rect.offset, rect.width,
+                                              width, rect.height);
         }
 
         /**
@@ -88,17 +173,38 @@ namespace r2d2::display {
          */
         void set_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
                         const uint16_t data) override {
-            st7735_unbuffered_c::set_cursor(x, y, x + width, y + height);
+            clipped_rectangle_s rect;
+            if (!this->clip_rectangle(x, y, width, height, rect)) {
+                return;
+            }
+
+            st7735_unbuffered_c::set_cursor(rect.x, rect.y,
+                                            rect.x + rect.width - 1,
+                                            rect.y + rect.height - 1);
 
             // write to ram
             st7735_unbuffered_c::write_command(st7735_unbuffered_c::RAMWR);
-            // make a copy and reverse byte order
-            const uint16_t inverted_data = __REV16(data); 
 
-            for (std::size_t i = 0; i < std::size_t((width + 1) * (height + 1));
-                 i++) {
-                st7735_unbuffered_c::write_data((uint8_t *)&inverted_data, 2);
-            }
+            // stream the color in a single transaction
+            st7735_unbuffered_c::fill_pixels(data, rect.width * rect.height);
+        }
+
+        /**
+         * This clears the display this overrides the default clear of hwlib
+         * because it writes every pixel with its own address window.
+         */
+        void clear(hwlib::color col) override {
+            set_pixels(0, 0, this->width, this->height,
+                       this->color_to_pixel(col));
+        }
+
+        /**
+         * This clears the display this overrides the default clear of hwlib
+         * because it writes every pixel with its own address window.
+         */
+        void clear() override {
+            // clear the screen with the background
+            clear(this->background);
         }
     };
 
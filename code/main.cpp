@@ -2,6 +2,7 @@
 #include <hwlib.hpp>
 
 #include <display_module.hpp>
+#include <display_static.hpp>
 #include <st7735_buffered.hpp>
 #include <st7735_unbuffered.hpp>
 #include <st7735_inverted_color_buffered.hpp>
@@ -9,6 +10,14 @@
 #include <display_screen.hpp>
 #include <ssd1306_oled_buffered.hpp>
 #include <ssd1306_oled_unbuffered.hpp>
+#include <ssd1306_oled_diff_buffered.hpp>
+#include <ssd1306_oled_async_buffered.hpp>
+#include <ssd1306_oled_console.hpp>
+#include <st7735_async_buffered.hpp>
+#include <st7735_band_buffered.hpp>
+#include <st7735_indexed_buffered.hpp>
+#include <st7735_rgb332_buffered.hpp>
+#include <st7735_terminal.hpp>
 
 int main() {
     // kill the watchdog
@@ -24,14 +33,14 @@ int main() {
 
 
     // use pin_dummy because chip select(cs) is controlled by the hardware spi
-    r2d2::display::st7735_buffered_c<
-        r2d2::display::st7735_128x160_s>
+    r2d2::display::static_display_c<r2d2::display::st7735_buffered_c<
+        r2d2::display::st7735_128x160_s>>
         color_display(spi_bus, pin_dummy, dc, rst);
 
     r2d2::comm_c comm;
 
-    r2d2::display::module_c<
-            r2d2::display::st7735_128x160_s> 
+    r2d2::display::coalescing_module_c<
+            r2d2::display::st7735_128x160_s, decltype(color_display)>
         module(comm, color_display);
 
     color_display.clear();
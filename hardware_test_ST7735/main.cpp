@@ -24,8 +24,8 @@ int main() {
 
     r2d2::comm_c comm;
 
-    r2d2::display::module_c<r2d2::display::st7735_128x160_s> module(
-        comm, color_display);
+    r2d2::display::coalescing_module_c<r2d2::display::st7735_128x160_s>
+        module(comm, color_display);
 
     // Loop to print the ascii characters starting with: !(33) ending with: ~(126). 
     for (char c=33; c <=126; c++){
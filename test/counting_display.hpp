@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <display_dummy.hpp>
+
+namespace r2d2::display {
+    /**
+     * Dummy display that counts the flushes, to test when a module flushes
+     * the display.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     */
+    template <class DisplayScreen>
+    class counting_display_c : public display_dummy_c<DisplayScreen> {
+    public:
+        // The amount of times the display has been flushed
+        std::size_t flush_count = 0;
+
+        /**
+         * @brief Counts the flushes instead of writing to a screen
+         *
+         */
+        void flush() override {
+            flush_count++;
+        }
+    };
+} // namespace r2d2::display
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace r2d2::i2c {
+    /**
+     * I2C bus for native builds, the I2C library only works on the arduino
+     * due. The bus emulates a ssd1306 that is connected to it: the control
+     * bytes, commands and data are decoded into an emulated display memory,
+     * so tests can check and measure what a driver sends.
+     *
+     * Every write is a single transaction. A control byte with the
+     * continuation bit set (0x80, 0xC0) is followed by one command or data
+     * byte and another control byte, without it (0x00, 0x40) the rest of the
+     * transaction are commands or data. Parameters of commands are commands
+     * as well. The horizontal, vertical and page addressing modes are
+     * emulated with their auto increment.
+     */
+    class i2c_bus_c {
+    public:
+        enum class interface { interface_0, interface_1 };
+
+        constexpr static uint8_t width = 128;
+        constexpr static uint8_t pages = 8;
+
+        // The emulated display memory, every byte is a column of 8 pixels
+        uint8_t memory[width * pages] = {};
+
+        // The amount of bytes written to the bus, including the control
+        // bytes
+        std::size_t bytes_written = 0;
+
+        // The amount of writes, every write is a transaction on the bus
+        std::size_t write_count = 0;
+
+        // The amount of control, command and data bytes received
+        std::size_t control_bytes = 0;
+        std::size_t command_bytes = 0;
+        std::size_t data_bytes = 0;
+
+        // The amount of command bytes that are not ssd1306 commands
+        std::size_t unknown_commands = 0;
+
+        // The address of the last write
+        uint_fast8_t address = 0;
+
+        // The state of the display
+        uint8_t memory_mode = 2;
+        uint8_t column_start = 0;
+        uint8_t column_end = width - 1;
+        uint8_t page_start = 0;
+        uint8_t page_end = pages - 1;
+        uint8_t start_line = 0;
+        uint8_t contrast = 0x7F;
+        bool display_on = false;
+        bool inverted = false;
+        bool scrolling = false;
+
+        i2c_bus_c(interface = interface::interface_0,
+                  unsigned int = 400'000) {
+        }
+
+        /**
+         * @brief Returns true if the pixel is on
+         *
+         * @param x
+         * @param y
+         */
+        bool pixel(uint8_t x, uint8_t y) const {
+            return memory[x + ((y / 8) * width)] & (1 << (y % 8));
+        }
+
+        /**
+         * @brief Returns true if the pixel is on at a position of the screen,
+         * the start line of the display is the top row of the screen
+         *
+         * @param x
+         * @param y
+         */
+        bool shown_pixel(uint8_t x, uint8_t y) const {
+            return pixel(x, (y + start_line) % (pages * 8));
+        }
+
+        void write(const uint_fast8_t address, const uint8_t data[],
+                   const size_t n) {
+            this->address = address;
+            bytes_written += n;
+            write_count++;
+
+            // a transaction starts with a control byte
+            bool expect_control = true;
+            bool continuation = false;
+            bool is_data = false;
+
+            for (std::size_t i = 0; i < n; i++) {
+                if (expect_control) {
+                    control_bytes++;
+                    continuation = data[i] & 0x80;
+                    is_data = data[i] & 0x40;
+                    expect_control = false;
+                    continue;
+                }
+
+                if (is_data) {
+                    write_data(data[i]);
+                } else {
+                    write_command(data[i]);
+                }
+
+                expect_control = continuation;
+            }
+        }
+
+    protected:
+        // The command that is waiting for parameters
+        uint8_t command = 0;
+        uint8_t parameters[6] = {};
+        uint8_t parameter = 0;
+        uint8_t parameter_count = 0;
+
+        // The position of the next data byte
+        uint8_t column = 0;
+        uint8_t page = 0;
+
+        /**
+         * @brief Returns the amount of parameters of a command, or -1 if it
+         * is not a ssd1306 command
+         *
+         * @param value
+         */
+        static int parameters_of(uint8_t value) {
+            switch (value) {
+                case 0x20: // memory_mode
+                case 0x81: // set_contrast
+                case 0x8D: // charge_pump
+                case 0xA8: // set_multiplex
+                case 0xD3: // set_display_offset
+                case 0xD5: // set_display_clock_div
+                case 0xD9: // set_precharge
+                case 0xDA: // set_compins
+                case 0xDB: // set_vcom_detect
+                    return 1;
+                case 0x21: // column_addr
+                case 0x22: // page_addr
+                case 0xA3: // set_vertical_scroll_area
+                    return 2;
+                case 0x29: // vertical_and_right_horizontal_scroll
+                case 0x2A: // vertical_and_left_horizontal_scroll
+                    return 5;
+                case 0x26: // right_horizontal_scroll
+                case 0x27: // left_horizontal_scroll
+                    return 6;
+                case 0x2E: // deactivate_scroll
+                case 0x2F: // activate_scroll
+                case 0xA0: // seg_remap
+                case 0xA1:
+                case 0xA4: // display_all_on_resume
+                case 0xA5: // display_all_on
+                case 0xA6: // normal_display
+                case 0xA7: // invert_display
+                case 0xAE: // display_off
+                case 0xAF: // display_on
+                case 0xC0: // com_scan_inc
+                case 0xC8: // com_scan_dec
+                case 0xE3: // nop
+                    return 0;
+                default:
+                    break;
+            }
+
+            // set_low_column, set_high_column, set_start_line and the page
+            // start of the page addressing mode
+            if (value < 0x20 || (value >= 0x40 && value < 0x80) ||
+                (value >= 0xB0 && value < 0xB8)) {
+                return 0;
+            }
+
+            return -1;
+        }
+
+        void write_command(uint8_t value) {
+            command_bytes++;
+
+            // a parameter of the previous command
+            if (parameter < parameter_count) {
+                parameters[parameter++] = value;
+
+                if (parameter == parameter_count) {
+                    execute();
+                }
+                return;
+            }
+
+            const int count = parameters_of(value);
+            if (count < 0) {
+                unknown_commands++;
+                return;
+            }
+
+            command = value;
+            parameter = 0;
+            parameter_count = count;
+
+            if (count == 0) {
+                execute();
+            }
+        }
+
+        void execute() {
+            if (command < 0x10) {
+                column = (column & 0xF0) | command;
+            } else if (command < 0x20) {
+                column = (column & 0x0F) | ((command & 0x0F) << 4);
+            } else if (command >= 0x40 && command < 0x80) {
+                start_line = command & 0x3F;
+            } else if (command >= 0xB0 && command < 0xB8) {
+                page = command & 0x07;
+            }
+
+            switch (command) {
+                case 0x20:
+                    memory_mode = parameters[0] & 0x03;
+                    break;
+                case 0x21:
+                    column_start = parameters[0] & 0x7F;
+                    column_end = parameters[1] & 0x7F;
+                    column = column_start;
+                    break;
+                case 0x22:
+                    page_start = parameters[0] & 0x07;
+                    page_end = parameters[1] & 0x07;
+                    page = page_start;
+                    break;
+                case 0x81:
+                    contrast = parameters[0];
+                    break;
+                case 0xA6:
+                    inverted = false;
+                    break;
+                case 0xA7:
+                    inverted = true;
+                    break;
+                case 0xAE:
+                    display_on = false;
+                    break;
+                case 0xAF:
+                    display_on = true;
+                    break;
+                case 0x2E:
+                    scrolling = false;
+                    break;
+                case 0x2F:
+                    scrolling = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void write_data(uint8_t value) {
+            data_bytes++;
+
+            if (column < width && page < pages) {
+                memory[column + (page * width)] = value;
+            }
+
+            // page addressing mode, the column wraps within the page
+            if (memory_mode == 2) {
+                column = column < width - 1 ? column + 1 : 0;
+                return;
+            }
+
+            // vertical addressing mode
+            if (memory_mode == 1) {
+                if (page < page_end) {
+                    page++;
+                    return;
+                }
+
+                page = page_start;
+                column = column < column_end ? column + 1 : column_start;
+                return;
+            }
+
+            // horizontal addressing mode
+            if (column < column_end) {
+                column++;
+                return;
+            }
+
+            column = column_start;
+            page = page < page_end ? page + 1 : page_start;
+        }
+    };
+} // namespace r2d2::i2c
@@ -3,9 +3,28 @@
 
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
+#include <algorithm>
+#include <counting_display.hpp>
 #include <display_dummy.hpp>
+#include <display_fill.hpp>
 #include <display_module.hpp>
+#include <display_static.hpp>
 #include <hwlib.hpp>
+#include <mock_async_bus.hpp>
+#include <mock_spi_bus.hpp>
+#include <reference_display.hpp>
+#include <ssd1306_oled_buffered.hpp>
+#include <ssd1306_oled_console.hpp>
+#include <ssd1306_oled_diff_buffered.hpp>
+#include <ssd1306_oled_unbuffered.hpp>
+#include <st7735_async_buffered.hpp>
+#include <st7735_band_buffered.hpp>
+#include <st7735_emulator.hpp>
+#include <st7735_indexed_buffered.hpp>
+#include <st7735_inverted_color_buffered.hpp>
+#include <st7735_rgb332_buffered.hpp>
+#include <st7735_terminal.hpp>
+#include <st7735_unbuffered.hpp>
 
 /*
  * Tests the default initialization of the cursors.
@@ -76,7 +95,7 @@ TEST_CASE("Manipulate cursor position out of bounds",
     // Dummy display does nothing in set_pixel
     r2d2::display::display_dummy_c<r2d2::display::st7735_128x160_s> test_display;
 
-    r2d2::display::module_c module(mock_bus, test_display);
+    r2d2::display::coalescing_module_c module(mock_bus, test_display);
 
     SECTION("X out of bounds"){
         constexpr uint8_t start_x = 50;
@@ -193,7 +212,7 @@ TEST_CASE("Manipulate cursor position through character writing",
         r2d2::display::st7735_128x160_s>
         test_display;
 
-    r2d2::display::module_c module(mock_bus, test_display);
+    r2d2::display::coalescing_module_c module(mock_bus, test_display);
 
     SECTION("Within bounds") {
         constexpr uint8_t start_x = 50;
@@ -293,7 +312,7 @@ TEST_CASE("Change cursor color", "[cursor, internal_communication]") {
         r2d2::display::st7735_128x160_s>
         test_display;
 
-    r2d2::display::module_c module(mock_bus, test_display);
+    r2d2::display::coalescing_module_c module(mock_bus, test_display);
     SECTION("To red") {
         constexpr uint8_t red = 255;
         constexpr uint8_t green = 0;
@@ -405,4 +424,1876 @@ TEST_CASE("Change cursor color", "[cursor, internal_communication]") {
         REQUIRE(cursor_color.green == green);
         REQUIRE(cursor_color.blue == blue);
     }
-}
\ No newline at end of file
+}
+
+/*
+ * Rectangles are merged when a single address window is cheaper than two,
+ * rectangles far apart are flushed on their own.
+ */
+TEST_CASE("Dirty region merging", "[dirty_region]") {
+    // a window costs 32 pixels, at most 4 rectangles
+    r2d2::display::dirty_region_c<4, 32> dirty;
+
+    SECTION("Rectangle inside another") {
+        dirty.add(10, 10, 20, 20);
+        dirty.add(12, 12, 15, 15);
+
+        REQUIRE(dirty.size() == 1);
+        REQUIRE(dirty.begin()->area() == 11 * 11);
+    }
+
+    SECTION("Neighbours") {
+        dirty.add(0, 0, 9, 0);
+        dirty.add(10, 0, 19, 0);
+
+        REQUIRE(dirty.size() == 1);
+        REQUIRE(dirty.begin()->x_min == 0);
+        REQUIRE(dirty.begin()->x_max == 19);
+    }
+
+    SECTION("Far apart") {
+        dirty.add(0, 0, 3, 3);
+        dirty.add(100, 100, 103, 103);
+
+        REQUIRE(dirty.size() == 2);
+    }
+
+    SECTION("Merged rectangle merges again") {
+        dirty.add(0, 0, 9, 9);
+        dirty.add(40, 0, 49, 9);
+        REQUIRE(dirty.size() == 2);
+
+        // fills the gap between both rectangles
+        dirty.add(10, 0, 39, 9);
+
+        REQUIRE(dirty.size() == 1);
+        REQUIRE(dirty.begin()->area() == 50 * 10);
+    }
+
+    SECTION("Full list") {
+        dirty.add(0, 0, 1, 1);
+        dirty.add(50, 0, 51, 1);
+        dirty.add(0, 50, 1, 51);
+        dirty.add(50, 50, 51, 51);
+        dirty.add(100, 100, 101, 101);
+
+        // merged with the closest rectangle
+        REQUIRE(dirty.size() == 4);
+
+        bool covered = false;
+        for (const auto &rect : dirty) {
+            covered = covered || rect.contains({100, 100, 101, 101});
+        }
+        REQUIRE(covered);
+    }
+
+    SECTION("Take rows") {
+        dirty.add(0, 0, 9, 19);
+
+        std::size_t sent = 0;
+        dirty.take(5, 9, [&](const r2d2::display::dirty_rectangle_s &rect) {
+            REQUIRE(rect.y_min == 5);
+            REQUIRE(rect.y_max == 9);
+            sent++;
+        });
+
+        // the rows above and below stay dirty
+        REQUIRE(sent == 1);
+        REQUIRE(dirty.size() == 2);
+    }
+
+    SECTION("Buffered flush") {
+        r2d2::display::mock_spi_bus_c bus;
+        auto pin_dummy = hwlib::pin_out_dummy;
+
+        r2d2::display::st7735_buffered_c<r2d2::display::st7735_128x160_s>
+            display(bus, pin_dummy, pin_dummy, pin_dummy);
+
+        display.flush();
+
+        // CASET, RASET and RAMWR with their data for every window
+        constexpr std::size_t window = 1 + 4 + 1 + 4 + 1;
+
+        bus.bytes_written = 0;
+        display.set_pixels(0, 0, 2, 2, uint16_t(0xFFFF));
+        display.set_pixels(100, 150, 2, 2, uint16_t(0xFFFF));
+        display.flush();
+
+        REQUIRE(bus.bytes_written == (2 * window) + (2 * 2 * 2 * 2));
+
+        bus.bytes_written = 0;
+        display.set_pixels(0, 0, 2, 2, uint16_t(0x0000));
+        display.set_pixels(2, 0, 2, 2, uint16_t(0x0000));
+        display.flush();
+
+        REQUIRE(bus.bytes_written == window + (4 * 2 * 2));
+
+        // nothing changed
+        bus.bytes_written = 0;
+        display.flush();
+        REQUIRE(bus.bytes_written == 0);
+    }
+}
+
+/*
+ * The diff buffered ssd1306 only sends the runs of bytes that differ from
+ * what the display holds. Runs with a small gap between them are sent as a
+ * single run.
+ */
+TEST_CASE("Ssd1306 diff flush", "[ssd1306]") {
+    r2d2::i2c::i2c_bus_c bus;
+    r2d2::display::ssd1306_oled_diff_buffered_c<
+        r2d2::display::ssd1306_128x64_s>
+        display(bus, 0x3C);
+
+    // the first flush sends the whole buffer
+    std::size_t data_bytes = bus.data_bytes;
+    display.flush();
+    REQUIRE(bus.data_bytes - data_bytes == 128 * 64 / 8);
+
+    std::size_t writes = bus.write_count;
+    data_bytes = bus.data_bytes;
+
+    auto require_sent = [&](std::size_t runs, std::size_t bytes) {
+        display.flush();
+
+        // every run is an address window and the data
+        REQUIRE(bus.write_count - writes == runs * 2);
+        REQUIRE(bus.data_bytes - data_bytes == bytes);
+
+        writes = bus.write_count;
+        data_bytes = bus.data_bytes;
+    };
+
+    SECTION("Nothing changed") {
+        require_sent(0, 0);
+    }
+
+    SECTION("Single pixel") {
+        display.set_pixel(20, 20, 1);
+        require_sent(1, 1);
+
+        // drawing the same pixel again changes nothing
+        display.set_pixel(20, 20, 1);
+        require_sent(0, 0);
+    }
+
+    SECTION("Small gap") {
+        // the gap costs less than a new window
+        display.set_pixel(20, 0, 1);
+        display.set_pixel(30, 0, 1);
+        require_sent(1, 11);
+    }
+
+    SECTION("Big gap") {
+        display.set_pixel(20, 0, 1);
+        display.set_pixel(32, 0, 1);
+        require_sent(2, 2);
+    }
+
+    SECTION("Multiple pages") {
+        display.set_pixels(0, 4, 3, 8, uint16_t(1));
+        require_sent(2, 6);
+    }
+
+    SECTION("Invalidate") {
+        display.invalidate();
+        require_sent(1, 128 * 64 / 8);
+    }
+}
+
+/*
+ * A blit on the unbuffered st7735 opens an address window of exactly the
+ * size of the visible pixels and streams them in a single transaction, also
+ * when a row is longer than the staging buffer.
+ */
+TEST_CASE("St7735 unbuffered blit", "[st7735]") {
+    using namespace r2d2::display;
+    using screen = st7735_128x160_s;
+
+    st7735_emulator_c emulator;
+    mock_cs_pin_c cs;
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    st7735_unbuffered_c<screen> display(emulator, cs, emulator.dc,
+                                        pin_dummy);
+
+    // rows of 40 pixels don't fit in the staging buffer of 32 pixels
+    uint16_t block[40 * 3];
+    for (std::size_t i = 0; i < 40 * 3; i++) {
+        block[i] = uint16_t(i + 1);
+    }
+
+    SECTION("Whole block") {
+        const std::size_t transactions = cs.transactions;
+        display.set_pixels(10, 20, 40, 3, block);
+
+        // CASET, RASET and RAMWR with their data and the pixels
+        REQUIRE(cs.transactions - transactions == 6);
+
+        REQUIRE(emulator.x_start == 10 + screen::x_offset);
+        REQUIRE(emulator.x_end == 49 + screen::x_offset);
+        REQUIRE(emulator.y_start == 20 + screen::y_offset);
+        REQUIRE(emulator.y_end == 22 + screen::y_offset);
+        REQUIRE(emulator.wrapped_pixels == 0);
+
+        for (uint16_t y = 0; y < 3; y++) {
+            for (uint16_t x = 0; x < 40; x++) {
+                REQUIRE(emulator.pixel(10 + x, 20 + y, screen::x_offset,
+                                       screen::y_offset) ==
+                        block[x + (y * 40)]);
+            }
+        }
+
+        // the pixels around the block are untouched
+        REQUIRE(emulator.pixel(9, 20, screen::x_offset, screen::y_offset) ==
+                0);
+        REQUIRE(emulator.pixel(50, 20, screen::x_offset, screen::y_offset) ==
+                0);
+        REQUIRE(emulator.pixel(10, 23, screen::x_offset, screen::y_offset) ==
+                0);
+    }
+
+    SECTION("Clipped block") {
+        display.set_pixels(screen::width - 8, 0, 40, 3, block);
+
+        REQUIRE(emulator.x_end == screen::width - 1 + screen::x_offset);
+        REQUIRE(emulator.wrapped_pixels == 0);
+
+        // every row starts at the same column of the data
+        for (uint16_t y = 0; y < 3; y++) {
+            REQUIRE(emulator.pixel(screen::width - 8, y, screen::x_offset,
+                                   screen::y_offset) == block[y * 40]);
+        }
+    }
+}
+
+/*
+ * A fill on the unbuffered st7735 streams a block of pixels in a single
+ * transaction. The block is only rebuilt when the color changes.
+ */
+TEST_CASE("St7735 unbuffered fill", "[st7735]") {
+    using namespace r2d2::display;
+    using screen = st7735_80x160_s;
+
+    st7735_emulator_c emulator;
+    mock_cs_pin_c cs;
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    st7735_unbuffered_c<screen> display(emulator, cs, emulator.dc,
+                                        pin_dummy);
+
+    auto require_filled = [&](uint16_t x, uint16_t y, uint16_t width,
+                              uint16_t height, uint16_t data) {
+        std::size_t differences = 0;
+        for (uint16_t p_y = y; p_y < y + height; p_y++) {
+            for (uint16_t p_x = x; p_x < x + width; p_x++) {
+                if (emulator.pixel(p_x, p_y, screen::x_offset,
+                                   screen::y_offset) != data) {
+                    differences++;
+                }
+            }
+        }
+
+        REQUIRE(differences == 0);
+        REQUIRE(emulator.wrapped_pixels == 0);
+    };
+
+    // more pixels than the block, with a last chunk that is not full
+    std::size_t transactions = cs.transactions;
+    std::size_t bytes = emulator.bytes_written;
+    display.set_pixels(3, 5, 20, 5, uint16_t(0xF800));
+
+    REQUIRE(cs.transactions - transactions == 6);
+    REQUIRE(emulator.bytes_written - bytes == 1 + 4 + 1 + 4 + 1 + (100 * 2));
+    require_filled(3, 5, 20, 5, 0xF800);
+
+    // the same color again and a new color
+    display.set_pixels(3, 5, 2, 2, uint16_t(0xF800));
+    require_filled(3, 5, 20, 5, 0xF800);
+
+    display.set_pixels(4, 6, 3, 1, uint16_t(0x07E0));
+    require_filled(4, 6, 3, 1, 0x07E0);
+    require_filled(3, 7, 20, 3, 0xF800);
+
+    // the whole screen in a single transaction
+    transactions = cs.transactions;
+    display.clear(hwlib::blue);
+
+    REQUIRE(cs.transactions - transactions == 6);
+    require_filled(0, 0, screen::width, screen::height,
+                   display.color_to_pixel(hwlib::blue));
+}
+
+/*
+ * The packed glyphs are the characters of the hwlib font. A transparent
+ * character only draws its own pixels. The default set_pixels of display_c
+ * writes rectangles that are not square.
+ */
+TEST_CASE("Glyphs", "[character]") {
+    using namespace r2d2::display;
+    using screen = st7735_80x160_s;
+
+    SECTION("Glyph table") {
+        hwlib::font_default_8x8 font;
+        std::size_t differences = 0;
+
+        for (uint8_t character = 0; character < 128; character++) {
+            const hwlib::image &image = font[static_cast<char>(character)];
+            const uint8_t *glyph = default_glyph(character);
+
+            for (uint8_t y = 0; y < 8; y++) {
+                for (uint8_t x = 0; x < 8; x++) {
+                    const bool set = glyph[y] & (0x80 >> x);
+                    if (set != (image[hwlib::xy(x, y)] != hwlib::white)) {
+                        differences++;
+                    }
+                }
+            }
+        }
+
+        REQUIRE(differences == 0);
+    }
+
+    SECTION("Expanded row") {
+        uint16_t pixels[8];
+        expand_glyph_row(0b10110001, 0xAAAA, 0x5555, pixels);
+
+        const uint16_t expected[] = {0xAAAA, 0x5555, 0xAAAA, 0xAAAA,
+                                     0x5555, 0x5555, 0x5555, 0xAAAA};
+        REQUIRE(std::equal(pixels, pixels + 8, expected));
+    }
+
+    SECTION("Transparent background") {
+        reference_display_c<screen> display;
+        display.set_pixels(0, 0, 16, 16, uint16_t(0x1234));
+
+        display.set_transparent_background(true);
+        display.set_character(4, 4, 'A', 0xFFFF);
+
+        const uint8_t *glyph = default_glyph('A');
+        std::size_t differences = 0;
+
+        for (uint16_t y = 0; y < 16; y++) {
+            for (uint16_t x = 0; x < 16; x++) {
+                const bool in_glyph = x >= 4 && x < 12 && y >= 4 && y < 12 &&
+                                      (glyph[y - 4] & (0x80 >> (x - 4)));
+
+                if (display.pixel(x, y) != (in_glyph ? 0xFFFF : 0x1234)) {
+                    differences++;
+                }
+            }
+        }
+
+        REQUIRE(differences == 0);
+    }
+
+    SECTION("Rectangles that are not square") {
+        reference_display_c<screen> display;
+
+        uint16_t row[10 * 2];
+        for (std::size_t i = 0; i < 10 * 2; i++) {
+            row[i] = uint16_t(i + 1);
+        }
+
+        // used to write width rows
+        display.set_pixels(0, 0, 10, 2, row);
+        display.set_pixels(20, 0, 2, 10, uint16_t(0xFFFF));
+
+        REQUIRE(display.pixel(9, 1) == 20);
+        REQUIRE(display.pixel(0, 2) == 0);
+        REQUIRE(display.pixel(21, 9) == 0xFFFF);
+        REQUIRE(display.pixel(22, 0) == 0);
+    }
+}
+
+/*
+ * A string on the unbuffered st7735 is written with a single address window
+ * and a single data transaction, also when it is clipped.
+ */
+TEST_CASE("St7735 unbuffered strings", "[st7735, character]") {
+    using namespace r2d2::display;
+    using screen = st7735_128x160_s;
+
+    st7735_emulator_c emulator;
+    mock_cs_pin_c cs;
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    st7735_unbuffered_c<screen> display(emulator, cs, emulator.dc,
+                                        pin_dummy);
+    reference_display_c<screen> reference;
+
+    auto draw = [&](auto &target) {
+        target.clear();
+        target.set_character(4, 10, "Hello world!", 0xF800);
+
+        // clipped on the left, the top and by the screen
+        target.set_clip(10, 22, 100, 100);
+        target.set_character(6, 20, "clipped", 0x07E0);
+        target.reset_clip();
+        target.set_character(screen::width - 20, 40, "edge", 0x001F);
+    };
+
+    draw(reference);
+    display.clear();
+
+    const std::size_t transactions = cs.transactions;
+    draw(display);
+
+    // the clear and every string are CASET, RASET and RAMWR with their data
+    REQUIRE(cs.transactions - transactions == 4 * 6);
+
+    std::size_t differences = 0;
+    for (uint16_t y = 0; y < screen::height; y++) {
+        for (uint16_t x = 0; x < screen::width; x++) {
+            if (emulator.pixel(x, y, screen::x_offset, screen::y_offset) !=
+                reference.pixel(x, y)) {
+                differences++;
+            }
+        }
+    }
+
+    REQUIRE(differences == 0);
+    REQUIRE(emulator.wrapped_pixels == 0);
+}
+
+/*
+ * The midpoint circle of the first version of display_c, a pixel at a time.
+ * Pixels outside of the screen are skipped.
+ */
+template <class DisplayScreen>
+void draw_baseline_circle(r2d2::display::display_c<DisplayScreen> &display,
+                          int x, int y, int radius, bool filled,
+                          uint16_t data) {
+    auto set_pixel = [&](int p_x, int p_y) {
+        if (p_x >= 0 && p_x < DisplayScreen::width && p_y >= 0 &&
+            p_y < DisplayScreen::height) {
+            display.set_pixel(p_x, p_y, data);
+        }
+    };
+
+    int t_x = radius;
+    int t_y = 0;
+    int err = 0;
+
+    if (filled) {
+        int x_change = 1 - (radius << 1);
+        int y_change = 0;
+
+        while (t_x >= t_y) {
+            for (int i = x - t_x; i <= x + t_x; i++) {
+                set_pixel(i, y + t_y);
+                set_pixel(i, y - t_y);
+            }
+            for (int i = x - t_y; i <= x + t_y; i++) {
+                set_pixel(i, y + t_x);
+                set_pixel(i, y - t_x);
+            }
+
+            t_y++;
+            err += y_change;
+            y_change += 2;
+            if (((err << 1) + x_change) > 0) {
+                t_x--;
+                err += x_change;
+                x_change += 2;
+            }
+        }
+    } else {
+        while (t_x >= t_y) {
+            set_pixel(x + t_x, y + t_y);
+            set_pixel(x + t_y, y + t_x);
+            set_pixel(x - t_y, y + t_x);
+            set_pixel(x - t_x, y + t_y);
+            set_pixel(x - t_x, y - t_y);
+            set_pixel(x - t_y, y - t_x);
+            set_pixel(x + t_y, y - t_x);
+            set_pixel(x + t_x, y - t_y);
+
+            if (err <= 0) {
+                t_y += 1;
+                err += 2 * t_y + 1;
+            }
+
+            if (err > 0) {
+                t_x -= 1;
+                err -= 2 * t_x + 1;
+            }
+        }
+    }
+}
+
+/*
+ * Circles are drawn as spans, but have the same pixels as the midpoint
+ * circle the drivers have always drawn.
+ */
+TEST_CASE("Circle shape", "[display, circle]") {
+    using namespace r2d2::display;
+    using screen = st7735_128x160_s;
+
+    // midpoints in the middle of the screen and clipped by the edges
+    const struct {
+        int x;
+        int y;
+    } midpoints[] = {{64, 80}, {2, 3}, {screen::width - 3, 150}};
+
+    for (const auto &midpoint : midpoints) {
+        for (int radius = 0; radius <= 40; radius++) {
+            for (bool filled : {true, false}) {
+                reference_display_c<screen> display;
+                reference_display_c<screen> baseline;
+
+                display.set_pixels_circle(midpoint.x, midpoint.y, radius,
+                                          filled, 0xFFFF);
+                draw_baseline_circle<screen>(baseline, midpoint.x, midpoint.y,
+                                             radius, filled, 0xFFFF);
+
+                std::size_t differences = 0;
+                for (int y = 0; y < screen::height; y++) {
+                    for (int x = 0; x < screen::width; x++) {
+                        if (display.pixel(x, y) != baseline.pixel(x, y)) {
+                            differences++;
+                        }
+                    }
+                }
+
+                INFO("radius " << radius << (filled ? " filled" : ""));
+                REQUIRE(differences == 0);
+            }
+        }
+    }
+}
+
+/*
+ * Clipped primitives draw exactly the pixels of the unclipped primitive that
+ * are inside the clip rectangle. The minimum of the clip is inclusive, the
+ * maximum exclusive.
+ */
+TEST_CASE("Clipping edges", "[display, clip]") {
+    using namespace r2d2::display;
+    using screen = st7735_128x160_s;
+
+    constexpr int clip_x = 10;
+    constexpr int clip_y = 20;
+    constexpr int clip_width = 30;
+    constexpr int clip_height = 40;
+
+    uint16_t block[40 * 50];
+    for (std::size_t i = 0; i < 40 * 50; i++) {
+        block[i] = uint16_t(i + 1);
+    }
+
+    // every primitive crosses at least one edge of the clip rectangle
+    auto draw = [&](auto &target) {
+        target.set_pixels(5, 15, 40, 50, block);
+        target.set_pixels(36, 56, 10, 10, uint16_t(0xF800));
+        target.set_character(4, 30, "clip", 0x07E0);
+
+        target.set_transparent_background(true);
+        target.set_character(34, 16, 'T', 0x001F);
+        target.set_transparent_background(false);
+
+        target.set_pixels_circle(12, 58, 6, true, 0x1234);
+        target.set_pixels_circle(38, 22, 5, false, 0x4321);
+
+        for (int i = 0; i < 50; i++) {
+            target.write(hwlib::xy(i, 12 + i), hwlib::white);
+        }
+    };
+
+    auto require_clipped = [&](auto pixel) {
+        reference_display_c<screen> full;
+        draw(full);
+
+        std::size_t differences = 0;
+        for (uint16_t y = 0; y < screen::height; y++) {
+            for (uint16_t x = 0; x < screen::width; x++) {
+                const bool in_clip = x >= clip_x && x < clip_x + clip_width &&
+                                     y >= clip_y && y < clip_y + clip_height;
+
+                if (pixel(x, y) != (in_clip ? full.pixel(x, y) : 0)) {
+                    differences++;
+                }
+            }
+        }
+
+        REQUIRE(differences == 0);
+    };
+
+    SECTION("Display defaults") {
+        reference_display_c<screen> display;
+        display.set_clip(clip_x, clip_y, clip_width, clip_height);
+        draw(display);
+
+        require_clipped(
+            [&](uint16_t x, uint16_t y) { return display.pixel(x, y); });
+
+        // the data of a clipped block starts at the first visible pixel
+        REQUIRE(display.pixel(clip_x, clip_y) == 1 + 5 + (5 * 40));
+    }
+
+    SECTION("Unbuffered st7735") {
+        st7735_emulator_c emulator;
+        auto pin_dummy = hwlib::pin_out_dummy;
+
+        st7735_unbuffered_c<screen, rgb565_native_s> display(
+            emulator, pin_dummy, emulator.dc, pin_dummy);
+        display.clear();
+        display.set_clip(clip_x, clip_y, clip_width, clip_height);
+        draw(display);
+
+        require_clipped(
+            [&](uint16_t x, uint16_t y) { return emulator.pixel(x, y); });
+        REQUIRE(emulator.wrapped_pixels == 0);
+    }
+
+    SECTION("Clip larger than the screen") {
+        reference_display_c<screen> display;
+        display.set_clip(100, 150, 100, 100);
+        display.set_pixels(0, 0, screen::width, screen::height,
+                           uint16_t(0xFFFF));
+
+        REQUIRE(display.pixel(99, 150) == 0);
+        REQUIRE(display.pixel(100, 149) == 0);
+        REQUIRE(display.pixel(100, 150) == 0xFFFF);
+        REQUIRE(display.pixel(screen::width - 1, screen::height - 1) ==
+                0xFFFF);
+    }
+}
+
+/*
+ * The conversion to RGB565 rounds the same way as scaling every component
+ * with a division.
+ */
+TEST_CASE("Pixel formats", "[color]") {
+    using namespace r2d2::display;
+
+    std::size_t differences = 0;
+    for (int c = 0; c < 256; c++) {
+        const auto value = uint8_t(c);
+        const uint16_t expected = (c * 0x1F / 0xFF) << 11 |
+                                  (c * 0x3F / 0xFF) << 5 | (c * 0x1F / 0xFF);
+
+        if (color_to_rgb565(hwlib::color(value, value, value)) != expected) {
+            differences++;
+        }
+    }
+
+    REQUIRE(differences == 0);
+    REQUIRE(color_to_rgb565(hwlib::red) == 0xF800);
+    REQUIRE(color_to_rgb565(hwlib::white) == 0xFFFF);
+
+    REQUIRE(rgb565_big_endian_s::to_storage(0x1234) == 0x3412);
+    REQUIRE(rgb565_native_s::to_storage(0x1234) == 0x1234);
+}
+
+/*
+ * Clearing the screen only clears the clip rectangle, on the buffered and on
+ * the unbuffered st7735.
+ */
+TEST_CASE("Clear inside the clip", "[st7735, ssd1306, clip]") {
+    using namespace r2d2::display;
+    using screen = st7735_80x160_s;
+
+    auto draw = [](auto &display) {
+        display.clear(hwlib::red);
+        display.set_clip(10, 20, 30, 40);
+        display.clear(hwlib::blue);
+        display.reset_clip();
+        display.flush();
+    };
+
+    reference_display_c<screen, rgb565_big_endian_s> reference;
+    draw(reference);
+
+    REQUIRE(reference.pixel(9, 20) == color_to_rgb565(hwlib::red));
+    REQUIRE(reference.pixel(10, 20) == color_to_rgb565(hwlib::blue));
+    REQUIRE(reference.pixel(39, 59) == color_to_rgb565(hwlib::blue));
+    REQUIRE(reference.pixel(40, 59) == color_to_rgb565(hwlib::red));
+
+    auto require_cleared = [&](st7735_emulator_c &emulator) {
+        std::size_t differences = 0;
+        for (uint16_t y = 0; y < screen::height; y++) {
+            for (uint16_t x = 0; x < screen::width; x++) {
+                if (emulator.pixel(x, y, screen::x_offset, screen::y_offset) !=
+                    reference.pixel(x, y)) {
+                    differences++;
+                }
+            }
+        }
+
+        REQUIRE(differences == 0);
+    };
+
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    SECTION("Buffered") {
+        st7735_emulator_c emulator;
+        st7735_buffered_c<screen> display(emulator, pin_dummy, emulator.dc,
+                                          pin_dummy);
+        draw(display);
+        require_cleared(emulator);
+    }
+
+    SECTION("Unbuffered") {
+        st7735_emulator_c emulator;
+        st7735_unbuffered_c<screen> display(emulator, pin_dummy, emulator.dc,
+                                            pin_dummy);
+        draw(display);
+        require_cleared(emulator);
+    }
+
+    SECTION("Band buffered") {
+        st7735_emulator_c emulator;
+        st7735_band_buffered_c<screen> display(emulator, pin_dummy,
+                                               emulator.dc, pin_dummy);
+        draw(display);
+        require_cleared(emulator);
+    }
+
+    // the ssd1306 only has black and white
+    auto draw_mono = [](auto &display) {
+        display.clear(hwlib::black);
+        display.set_clip(10, 20, 30, 40);
+        display.clear(hwlib::white);
+        display.reset_clip();
+        display.flush();
+    };
+
+    auto require_mono_cleared = [&](r2d2::i2c::i2c_bus_c &bus) {
+        reference_display_c<ssd1306_128x64_s, mono_1bpp_s> mono_reference;
+        draw_mono(mono_reference);
+
+        std::size_t differences = 0;
+        for (uint16_t y = 0; y < ssd1306_128x64_s::height; y++) {
+            for (uint16_t x = 0; x < ssd1306_128x64_s::width; x++) {
+                if (bus.pixel(x, y) != (mono_reference.pixel(x, y) != 0)) {
+                    differences++;
+                }
+            }
+        }
+
+        REQUIRE(mono_reference.pixel(10, 20) == 1);
+        REQUIRE(mono_reference.pixel(9, 20) == 0);
+        REQUIRE(differences == 0);
+    };
+
+    SECTION("Ssd1306 buffered") {
+        r2d2::i2c::i2c_bus_c bus;
+        ssd1306_oled_buffered_c<ssd1306_128x64_s> display(bus, 0x3C);
+        draw_mono(display);
+        require_mono_cleared(bus);
+    }
+
+    SECTION("Ssd1306 unbuffered") {
+        r2d2::i2c::i2c_bus_c bus;
+        ssd1306_oled_unbuffered_c<ssd1306_128x64_s> display(bus, 0x3C);
+        draw_mono(display);
+        require_mono_cleared(bus);
+    }
+}
+
+/*
+ * Frames that arrive together are drawn first and flushed to the display
+ * once. When more frames arrive than the module is allowed to draw before a
+ * flush, the display is flushed in between.
+ */
+TEST_CASE("Flush coalescing", "[flush, internal_communication]") {
+    // The bus itself doesn't take any constructor arguments
+    r2d2::mock_comm_c mock_bus;
+
+    // Dummy display counts the flushes
+    r2d2::display::counting_display_c<r2d2::display::st7735_128x160_s>
+        test_display;
+
+    // Flush after at most 4 frames
+    r2d2::display::coalescing_module_c module(mock_bus, test_display, 4);
+
+    SECTION("Burst of frames") {
+        for (uint8_t i = 0; i < 3; i++) {
+            auto frame_rect =
+                mock_bus.create_frame<r2d2::frame_type::DISPLAY_RECTANGLE>(
+                    {i, i, 10, 10, 255, 255, 255});
+
+            mock_bus.accept_frame(frame_rect);
+        }
+
+        module.process();
+
+        REQUIRE(test_display.flush_count == 1);
+    }
+
+    SECTION("Frame limit") {
+        for (uint8_t i = 0; i < 10; i++) {
+            auto frame_circle =
+                mock_bus.create_frame<r2d2::frame_type::DISPLAY_CIRCLE>(
+                    {50, 50, i, true, 255, 0, 0});
+
+            mock_bus.accept_frame(frame_circle);
+        }
+
+        module.process();
+
+        // flushed after frame 4 and 8 and at the end
+        REQUIRE(test_display.flush_count == 3);
+    }
+
+    SECTION("Nothing drawn") {
+        auto frame_color =
+            mock_bus.create_frame<r2d2::frame_type::CURSOR_COLOR>(
+                {static_cast<uint8_t>(
+                     r2d2::claimed_display_cursor::OPEN_CURSOR),
+                 255, 0, 0});
+
+        mock_bus.accept_frame(frame_color);
+        module.process();
+
+        REQUIRE(test_display.flush_count == 0);
+    }
+}
+
+/*
+ * Clock for the flush schedulers of which the time is set by the test.
+ */
+class mock_clock_c : public r2d2::display::display_clock_c {
+public:
+    uint_fast64_t time_us = 0;
+
+    uint_fast64_t now_us() override {
+        return time_us;
+    }
+};
+
+/*
+ * With a frame rate of 10 fps the display may only be flushed every 100 ms.
+ * Frames are still drawn when they arrive, a flush that is not due yet is
+ * done by a later call to process.
+ */
+TEST_CASE("Frame rate flush scheduler", "[flush, internal_communication]") {
+    // The bus itself doesn't take any constructor arguments
+    r2d2::mock_comm_c mock_bus;
+
+    // Dummy display counts the flushes
+    r2d2::display::counting_display_c<r2d2::display::st7735_128x160_s>
+        test_display;
+
+    mock_clock_c clock;
+    r2d2::display::frame_rate_flush_scheduler_c scheduler(10, clock);
+
+    r2d2::display::module_c module(mock_bus, test_display, scheduler);
+
+    auto frame_rect =
+        mock_bus.create_frame<r2d2::frame_type::DISPLAY_RECTANGLE>(
+            {0, 0, 10, 10, 255, 255, 255});
+
+    // The first frame is flushed right away
+    mock_bus.accept_frame(frame_rect);
+    module.process();
+    REQUIRE(test_display.flush_count == 1);
+
+    // Frames within the frame period wait
+    clock.time_us = 40'000;
+    mock_bus.accept_frame(frame_rect);
+    mock_bus.accept_frame(frame_rect);
+    module.process();
+    REQUIRE(test_display.flush_count == 1);
+
+    // Nothing new arrived, but the waiting frames are now due
+    clock.time_us = 100'000;
+    module.process();
+    REQUIRE(test_display.flush_count == 2);
+
+    // Nothing to flush
+    clock.time_us = 250'000;
+    module.process();
+    REQUIRE(test_display.flush_count == 2);
+
+    // Without a cap every frame is flushed, also at the same time
+    r2d2::display::frame_rate_flush_scheduler_c uncapped(0, clock);
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(uncapped.frame_drawn());
+        uncapped.flushed();
+    }
+    REQUIRE_FALSE(uncapped.idle());
+}
+
+/*
+ * An async flush is moved forward by calling poll. With double buffering
+ * the screen receives the image of the moment the flush began, even when
+ * the buffer is drawn on during the flush.
+ */
+TEST_CASE("Async double buffered flush", "[flush, st7735]") {
+    r2d2::display::mock_spi_bus_c spi_bus;
+    r2d2::display::mock_async_bus_c async_bus(64);
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    r2d2::display::st7735_async_buffered_c<r2d2::display::st7735_80x160_s,
+                                           true>
+        display(spi_bus, pin_dummy, pin_dummy, pin_dummy, async_bus);
+
+    // The first flush sends the whole screen
+    display.flush();
+    REQUIRE(async_bus.written.size() == 80 * 160 * 2);
+    async_bus.written.clear();
+
+    SECTION("Drawing during a flush") {
+        // Two full rows are sent in a single write
+        display.set_pixels(0, 0, 80, 2, uint16_t(0xF800));
+        REQUIRE(display.begin_flush());
+        REQUIRE(display.is_flushing());
+
+        // Only one flush at a time
+        REQUIRE_FALSE(display.begin_flush());
+
+        display.set_pixels(0, 0, 80, 2, uint16_t(0x001F));
+
+        while (display.poll()) {
+        }
+
+        REQUIRE(async_bus.written.size() == 80 * 2 * 2);
+        for (std::size_t i = 0; i < async_bus.written.size(); i += 2) {
+            REQUIRE(async_bus.written[i] == 0xF8);
+            REQUIRE(async_bus.written[i + 1] == 0x00);
+        }
+
+        // The second drawing is sent by the next flush
+        async_bus.written.clear();
+        display.flush();
+
+        REQUIRE(async_bus.written.size() == 80 * 2 * 2);
+        REQUIRE(async_bus.written[0] == 0x00);
+        REQUIRE(async_bus.written[1] == 0x1F);
+    }
+
+    SECTION("Partial width region") {
+        const std::size_t writes = async_bus.write_count;
+
+        display.set_pixels(10, 10, 4, 3, uint16_t(0xFFFF));
+        display.begin_flush();
+
+        while (display.poll()) {
+        }
+
+        // Every row is written separately
+        REQUIRE(async_bus.write_count - writes == 3);
+        REQUIRE(async_bus.written.size() == 4 * 3 * 2);
+    }
+}
+
+/*
+ * An async driver that stores the pixels in the byte order of the processor
+ * sends the same bytes as one that stores them in the byte order of the
+ * screen.
+ */
+template <bool DoubleBuffer>
+void require_async_native_order() {
+    using namespace r2d2::display;
+
+    mock_spi_bus_c spi_bus;
+    mock_async_bus_c big_endian_bus(64);
+    mock_async_bus_c native_bus(64);
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    st7735_async_buffered_c<st7735_80x160_s, DoubleBuffer> big_endian(
+        spi_bus, pin_dummy, pin_dummy, pin_dummy, big_endian_bus);
+    st7735_async_buffered_c<st7735_80x160_s, DoubleBuffer, rgb565_native_s>
+        native(spi_bus, pin_dummy, pin_dummy, pin_dummy, native_bus);
+
+    for (auto *display : std::initializer_list<display_c<st7735_80x160_s> *>{
+             &big_endian, &native}) {
+        display->set_pixels(0, 0, 80, 2, uint16_t(0xF800));
+        display->set_pixels(10, 10, 4, 3, uint16_t(0x1234));
+        display->set_character(20, 30, 'A', 0x07E0);
+        display->flush();
+    }
+
+    REQUIRE(native_bus.written == big_endian_bus.written);
+}
+
+TEST_CASE("Async native byte order", "[flush, st7735]") {
+    SECTION("Single buffer") {
+        require_async_native_order<false>();
+    }
+
+    SECTION("Double buffer") {
+        require_async_native_order<true>();
+    }
+}
+
+/*
+ * A statically dispatched display draws exactly the same as the same driver
+ * that is used through the virtual functions of display_c.
+ */
+TEST_CASE("Static dispatch", "[st7735, internal_communication]") {
+    r2d2::display::mock_spi_bus_c spi_bus;
+    r2d2::display::mock_async_bus_c virtual_bus(4096);
+    r2d2::display::mock_async_bus_c static_bus(4096);
+    auto pin_dummy = hwlib::pin_out_dummy;
+
+    r2d2::display::st7735_async_buffered_c<r2d2::display::st7735_80x160_s>
+        virtual_display(spi_bus, pin_dummy, pin_dummy, pin_dummy,
+                        virtual_bus);
+
+    r2d2::display::static_display_c<r2d2::display::st7735_async_buffered_c<
+        r2d2::display::st7735_80x160_s>>
+        static_display(spi_bus, pin_dummy, pin_dummy, pin_dummy, static_bus);
+
+    r2d2::mock_comm_c mock_bus;
+
+    r2d2::display::coalescing_module_c virtual_module(mock_bus,
+                                                      virtual_display);
+    r2d2::display::coalescing_module_c<r2d2::display::st7735_80x160_s,
+                                       decltype(static_display)>
+        static_module(mock_bus, static_display);
+
+    auto frame_rect =
+        mock_bus.create_frame<r2d2::frame_type::DISPLAY_RECTANGLE>(
+            {5, 10, 30, 20, 255, 0, 0});
+    auto frame_circle =
+        mock_bus.create_frame<r2d2::frame_type::DISPLAY_CIRCLE>(
+            {40, 80, 25, false, 0, 255, 0});
+
+    for (auto module : std::initializer_list<r2d2::base_module_c *>{
+             &virtual_module, &static_module}) {
+        mock_bus.accept_frame(frame_rect);
+        mock_bus.accept_frame(frame_circle);
+        module->process();
+    }
+
+    // hwlib draws through write_implementation
+    for (auto display : std::initializer_list<hwlib::window *>{
+             &virtual_display, &static_display}) {
+        for (int i = 0; i < 80; i++) {
+            display->write(hwlib::xy(i, i * 2), hwlib::blue);
+        }
+        display->flush();
+    }
+
+    REQUIRE(virtual_bus.written.size() == static_bus.written.size());
+    REQUIRE(virtual_bus.written == static_bus.written);
+}
+
+/*
+ * The word wide fill kernels write exactly the same pixels as writing every
+ * pixel on its own, for every alignment and size of the rectangle.
+ */
+TEST_CASE("Fill kernels", "[fill]") {
+    constexpr uint16_t width = 20;
+    constexpr uint16_t height = 24;
+
+    SECTION("16 bit pixels") {
+        for (uint16_t x = 0; x < 5; x++) {
+            for (uint16_t w : {1, 2, 3, 8, 9, 15}) {
+                uint16_t buffer[width * height] = {};
+                uint16_t expected[width * height] = {};
+
+                for (uint16_t y = 3; y < 7; y++) {
+                    for (uint16_t i = x; i < x + w; i++) {
+                        expected[i + (y * width)] = 0xABCD;
+                    }
+                }
+
+                r2d2::display::buffer_fill_rectangle(buffer, width, x, 3, w,
+                                                     4, 0xABCD);
+
+                REQUIRE(std::equal(buffer, buffer + (width * height),
+                                   expected));
+            }
+        }
+
+        // a full width rectangle is a single run
+        uint16_t buffer[width * height] = {};
+        r2d2::display::buffer_fill_rectangle(buffer, width, 0, 1, width, 2,
+                                             0x1234);
+
+        REQUIRE(buffer[width - 1] == 0);
+        REQUIRE(buffer[width] == 0x1234);
+        REQUIRE(buffer[(3 * width) - 1] == 0x1234);
+        REQUIRE(buffer[3 * width] == 0);
+    }
+
+    SECTION("Pixels of a single bit") {
+        for (uint16_t y = 0; y < 10; y++) {
+            for (uint16_t h : {1, 5, 8, 9, 14}) {
+                for (uint16_t w : {uint16_t(3), width}) {
+                    for (bool on : {true, false}) {
+                        const uint8_t start = on ? 0x00 : 0xFF;
+                        uint8_t buffer[width * height / 8];
+                        uint8_t expected[width * height / 8];
+                        std::fill(buffer, buffer + sizeof(buffer), start);
+                        std::fill(expected, expected + sizeof(expected),
+                                  start);
+
+                        for (uint16_t p_y = y; p_y < y + h; p_y++) {
+                            for (uint16_t p_x = 0; p_x < w; p_x++) {
+                                uint8_t &column =
+                                    expected[p_x + ((p_y / 8) * width)];
+                                column = on ? column | (1 << (p_y % 8))
+                                            : column & ~(1 << (p_y % 8));
+                            }
+                        }
+
+                        r2d2::display::mono_buffer_fill_rectangle(
+                            buffer, width, 0, y, w, h, on);
+
+                        REQUIRE(std::equal(buffer, buffer + sizeof(buffer),
+                                           expected));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * The bus statistics count every transaction, byte, change of the data
+ * command pin, address window command and flush of a driver.
+ */
+TEST_CASE("Bus statistics", "[st7735, ssd1306]") {
+    SECTION("st7735") {
+        r2d2::display::mock_spi_bus_c bus;
+        auto pin_dummy = hwlib::pin_out_dummy;
+
+        r2d2::display::st7735_buffered_c<r2d2::display::st7735_128x160_s,
+                                         r2d2::display::rgb565_big_endian_s,
+                                         r2d2::display::bus_stats_c>
+            display(bus, pin_dummy, pin_dummy, pin_dummy);
+
+        display.flush();
+        display.reset_bus_stats();
+        bus.bytes_written = 0;
+
+        display.set_pixels(10, 10, 8, 8, uint16_t(0xFFFF));
+        display.flush();
+
+        const auto stats = display.get_bus_stats();
+
+        // CASET, RASET and RAMWR with their data
+        REQUIRE(stats.transactions == 6);
+        REQUIRE(stats.payload_bytes == bus.bytes_written);
+        REQUIRE(stats.payload_bytes == 1 + 4 + 1 + 4 + 1 + (8 * 8 * 2));
+        // the previous flush left the display in data mode
+        REQUIRE(stats.dc_toggles == 6);
+        REQUIRE(stats.address_window_commands == 2);
+        REQUIRE(stats.flushes == 1);
+
+        display.reset_bus_stats();
+        REQUIRE(display.get_bus_stats().transactions == 0);
+    }
+
+    SECTION("ssd1306") {
+        r2d2::i2c::i2c_bus_c bus;
+
+        r2d2::display::ssd1306_oled_buffered_c<r2d2::display::ssd1306_128x64_s,
+                                               r2d2::display::bus_stats_c>
+            display(bus, 0x3C);
+
+        display.reset_bus_stats();
+        bus.bytes_written = 0;
+
+        display.flush();
+
+        const auto stats = display.get_bus_stats();
+
+        // the address window is a single command stream
+        REQUIRE(stats.transactions == 2);
+        REQUIRE(stats.payload_bytes == bus.bytes_written);
+        REQUIRE(stats.payload_bytes == 7 + 1 + (128 * 64 / 8));
+        REQUIRE(stats.address_window_commands == 2);
+        REQUIRE(stats.flushes == 1);
+        REQUIRE(stats.dc_toggles == 0);
+    }
+
+    SECTION("Disabled by default") {
+        REQUIRE_FALSE(r2d2::display::st7735_buffered_c<
+                      r2d2::display::st7735_128x160_s>::bus_stats_enabled);
+        REQUIRE_FALSE(r2d2::display::ssd1306_oled_buffered_c<
+                      r2d2::display::ssd1306_128x64_s>::bus_stats_enabled);
+    }
+}
+
+/*
+ * Draws every kind of primitive, partly clipped by the screen and by a clip
+ * rectangle.
+ */
+template <class DisplayScreen>
+void draw_scene(r2d2::display::display_c<DisplayScreen> &display) {
+    constexpr uint16_t width = DisplayScreen::width;
+    constexpr uint16_t height = DisplayScreen::height;
+
+    display.clear();
+
+    display.set_pixels(5, 7, 30, 20, uint16_t(0xF800));
+    display.set_pixels(width - 10, height - 5, 30, 30, uint16_t(0x07E0));
+
+    uint16_t block[13 * 9];
+    for (std::size_t i = 0; i < 13 * 9; i++) {
+        block[i] = uint16_t(i * 0x0841);
+    }
+    display.set_pixels(20, 40, 13, 9, block);
+    display.set_pixels(width - 5, 0, 13, 9, block);
+
+    display.set_character(3, 60, 'R', 0xFFFF);
+    display.set_character(0, 70, "Hello world!", 0x001F);
+    display.set_character(width - 4, 80, 'W', 0x07FF);
+
+    display.set_transparent_background(true);
+    display.set_character(2, 72, "ab", 0xF81F);
+    display.set_transparent_background(false);
+
+    display.set_pixels_circle(40, 100, 15, true, 0x1234);
+    display.set_pixels_circle(width - 3, 120, 10, false, 0x4321);
+    display.set_pixels_circle(5, height - 2, 7, true, 0xFFE0);
+
+    for (uint16_t i = 0; i < 40; i++) {
+        display.write(hwlib::xy(i * 2, 140 + (i % 7)), hwlib::white);
+    }
+
+    display.set_clip(10, 10, 30, 30);
+    display.set_pixels(0, 0, width, 80, uint16_t(0xAAAA));
+    display.set_pixels_circle(40, 40, 20, false, 0x5555);
+    display.reset_clip();
+
+    display.flush();
+}
+
+/*
+ * Draws a few small changes after the scene, to test drivers that only
+ * send what changed.
+ */
+template <class DisplayScreen>
+void draw_changes(r2d2::display::display_c<DisplayScreen> &display) {
+    display.set_pixels(1, 1, 3, 3, uint16_t(0x8888));
+    display.set_character(40, 150, 'x', 0x0F0F);
+    display.set_pixels(DisplayScreen::width - 1, 90, 1, 1, uint16_t(0x1111));
+
+    display.flush();
+}
+
+/*
+ * Pixel mapping of require_same_image for images that hold the pixels of
+ * the reference unchanged.
+ */
+struct same_pixel_s {
+    uint16_t operator()(uint16_t pixel) const {
+        return pixel;
+    }
+};
+
+/*
+ * Compares the rows first_row up to last_row of an image with the reference
+ * display. actual(x, y) returns a pixel of the image, expected(pixel) maps a
+ * pixel of the reference to the value the image should have.
+ */
+template <class DisplayScreen, class PixelFormat, class Actual,
+          class Expected>
+void require_same_image(
+    Actual actual,
+    const r2d2::display::reference_display_c<DisplayScreen, PixelFormat>
+        &reference,
+    Expected expected, uint16_t first_row = 0,
+    uint16_t last_row = DisplayScreen::height) {
+    std::size_t differences = 0;
+
+    for (uint16_t y = first_row; y < last_row; y++) {
+        for (uint16_t x = 0; x < DisplayScreen::width; x++) {
+            if (actual(x, y) != expected(reference.pixel(x, y))) {
+                differences++;
+            }
+        }
+    }
+
+    REQUIRE(differences == 0);
+}
+
+/*
+ * Compares the memory of the emulated st7735 with the reference image.
+ */
+template <class DisplayScreen, class Expected = same_pixel_s>
+void require_same_image(
+    const r2d2::display::st7735_emulator_c &emulator,
+    const r2d2::display::reference_display_c<DisplayScreen> &reference,
+    Expected expected = {}, uint16_t first_row = 0,
+    uint16_t last_row = DisplayScreen::height) {
+    require_same_image(
+        [&](uint16_t x, uint16_t y) {
+            return emulator.pixel(x, y, DisplayScreen::x_offset,
+                                  DisplayScreen::y_offset);
+        },
+        reference, expected, first_row, last_row);
+
+    REQUIRE(emulator.wrapped_pixels == 0);
+}
+
+/*
+ * A st7735 driver that draws on the emulator, together with the reference
+ * display it is compared with.
+ */
+template <class DisplayScreen, class Display>
+struct st7735_fixture_s {
+    r2d2::display::st7735_emulator_c emulator;
+    Display display;
+    r2d2::display::reference_display_c<DisplayScreen> reference;
+
+    st7735_fixture_s()
+        : display(emulator, hwlib::pin_out_dummy, emulator.dc,
+                  hwlib::pin_out_dummy) {
+    }
+
+    /*
+     * Draws the same on the driver and on the reference display.
+     */
+    template <class Draw>
+    void draw(Draw &&draw_function) {
+        draw_function(display);
+        draw_function(reference);
+    }
+};
+
+/*
+ * Draws the scene on a st7735 driver and on the reference display, the
+ * emulated memory of the st7735 has to be the same as the reference.
+ */
+template <class DisplayScreen, class Display>
+void require_golden_image() {
+    st7735_fixture_s<DisplayScreen, Display> fixture;
+
+    // 16 bit pixels
+    REQUIRE(fixture.emulator.colmod == 0x05);
+
+    for (auto draw : {draw_scene<DisplayScreen>, draw_changes<DisplayScreen>}) {
+        fixture.draw(draw);
+        require_same_image(fixture.emulator, fixture.reference);
+    }
+}
+
+TEST_CASE("St7735 golden image", "[st7735]") {
+    using namespace r2d2::display;
+
+    SECTION("Buffered") {
+        require_golden_image<st7735_128x160_s,
+                             st7735_buffered_c<st7735_128x160_s>>();
+        require_golden_image<st7735_80x160_s,
+                             st7735_buffered_c<st7735_80x160_s>>();
+    }
+
+    SECTION("Unbuffered") {
+        require_golden_image<st7735_128x160_s,
+                             st7735_unbuffered_c<st7735_128x160_s>>();
+        require_golden_image<st7735_80x160_s,
+                             st7735_unbuffered_c<st7735_80x160_s>>();
+    }
+
+    SECTION("Native pixel format") {
+        require_golden_image<
+            st7735_80x160_s,
+            st7735_buffered_c<st7735_80x160_s, rgb565_native_s>>();
+    }
+
+    SECTION("Static dispatch") {
+        require_golden_image<
+            st7735_128x160_s,
+            static_display_c<st7735_buffered_c<st7735_128x160_s>>>();
+    }
+
+    SECTION("Inverted colors") {
+        r2d2::display::st7735_emulator_c emulator;
+        auto pin_dummy = hwlib::pin_out_dummy;
+
+        st7735_inverted_color_buffered_c<st7735_80x160_s> display(
+            emulator, pin_dummy, emulator.dc, pin_dummy);
+
+        REQUIRE(emulator.inverted);
+    }
+}
+
+/*
+ * A driver that only implements set_pixel uses the defaults of display_c for
+ * everything else. Through static_display_c those defaults call the driver
+ * directly, the image has to stay the same.
+ */
+TEST_CASE("Static dispatch of the display defaults", "[display]") {
+    using namespace r2d2::display;
+    using screen = st7735_80x160_s;
+    using driver = reference_display_c<screen>;
+
+    static_assert(
+        uses_display_default<void(uint16_t, uint16_t, char, uint16_t)>(
+            &driver::set_character));
+    static_assert(
+        uses_display_default<void(uint16_t, uint16_t, uint16_t, bool,
+                                  const uint16_t)>(&driver::set_pixels_circle));
+    static_assert(
+        !uses_display_default<void(uint16_t, uint16_t, char, uint16_t)>(
+            &static_display_c<driver>::set_character));
+
+    driver virtual_display;
+    static_display_c<driver> static_display;
+
+    for (auto draw : {draw_scene<screen>, draw_changes<screen>}) {
+        draw(virtual_display);
+        draw(static_display);
+    }
+
+    for (display_c<screen> *display :
+         std::initializer_list<display_c<screen> *>{&virtual_display,
+                                                    &static_display}) {
+        display->set_cursor_position(0, 10, 120);
+        display->set_cursor_color(0, hwlib::green);
+        display->set_character(0, "cursor");
+        display->set_pixels_circle(0, 9, false);
+    }
+
+    std::size_t differences = 0;
+    for (uint16_t y = 0; y < screen::height; y++) {
+        for (uint16_t x = 0; x < screen::width; x++) {
+            if (virtual_display.pixel(x, y) != static_display.pixel(x, y)) {
+                differences++;
+            }
+        }
+    }
+
+    REQUIRE(differences == 0);
+}
+
+/*
+ * Draws the scene on a ssd1306 driver and on the reference display, the
+ * emulated memory of the ssd1306 has to be the same as the reference.
+ */
+template <class Display>
+void require_ssd1306_golden_image(r2d2::i2c::i2c_bus_c &bus,
+                                  Display &display) {
+    using screen = r2d2::display::ssd1306_128x64_s;
+
+    r2d2::display::reference_display_c<screen, r2d2::display::mono_1bpp_s>
+        reference;
+
+    for (auto draw : {draw_scene<screen>, draw_changes<screen>}) {
+        draw(display);
+        draw(reference);
+
+        require_same_image(
+            [&](uint16_t x, uint16_t y) { return bus.pixel(x, y); },
+            reference, [](uint16_t pixel) { return pixel != 0; });
+    }
+
+    REQUIRE(bus.display_on);
+    REQUIRE(bus.memory_mode == 0);
+    REQUIRE(bus.contrast == 0xCF);
+    REQUIRE(bus.unknown_commands == 0);
+}
+
+TEST_CASE("Ssd1306 golden image", "[ssd1306]") {
+    using namespace r2d2::display;
+    r2d2::i2c::i2c_bus_c bus;
+
+    SECTION("Buffered") {
+        ssd1306_oled_buffered_c<ssd1306_128x64_s> display(bus, 0x3C);
+        require_ssd1306_golden_image(bus, display);
+
+        REQUIRE(bus.address == 0x3C);
+    }
+
+    SECTION("Unbuffered") {
+        ssd1306_oled_unbuffered_c<ssd1306_128x64_s> display(bus, 0x3C);
+        require_ssd1306_golden_image(bus, display);
+
+        // a glyph is sent as a single burst after the address window
+        const std::size_t writes = bus.write_count;
+        display.set_character(40, 40, 'A', uint16_t(1));
+
+        REQUIRE(bus.write_count - writes == 2);
+    }
+
+    SECTION("Diff buffered") {
+        ssd1306_oled_diff_buffered_c<ssd1306_128x64_s> display(bus, 0x3C);
+        require_ssd1306_golden_image(bus, display);
+
+        // the changes are sent without the rest of the buffer
+        const std::size_t data_bytes = bus.data_bytes;
+        display.set_pixels(1, 1, 3, 3, uint16_t(0));
+        display.flush();
+
+        REQUIRE(bus.data_bytes - data_bytes == 3);
+    }
+
+    SECTION("Static dispatch") {
+        static_display_c<ssd1306_oled_buffered_c<ssd1306_128x64_s>> display(
+            bus, 0x3C);
+        require_ssd1306_golden_image(bus, display);
+    }
+}
+
+TEST_CASE("Ssd1306 console", "[ssd1306]") {
+    using namespace r2d2::display;
+    using screen = ssd1306_128x64_s;
+
+    r2d2::i2c::i2c_bus_c bus;
+    ssd1306_oled_console_c<screen> display(bus, 0x3C);
+    reference_display_c<screen, mono_1bpp_s> reference;
+
+    const char *lines[] = {"zero", "one", "two",  "three", "four",  "five",
+                           "six",  "seven", "eight", "nine", "ten"};
+
+    // the screen shows the last lines of the console
+    auto require_shown_lines = [&](std::size_t last) {
+        reference.clear();
+
+        const std::size_t first = last >= 8 ? last - 7 : 0;
+        for (std::size_t line = first; line <= last; line++) {
+            reference.set_character(0, (line - first) * 8, lines[line],
+                                    uint16_t(1));
+        }
+
+        require_same_image(
+            [&](uint16_t x, uint16_t y) { return bus.shown_pixel(x, y); },
+            reference, [](uint16_t pixel) { return pixel != 0; });
+    };
+
+    display.flush();
+
+    for (std::size_t line = 0; line < 11; line++) {
+        const std::size_t writes = bus.write_count;
+        const std::size_t data_bytes = bus.data_bytes;
+
+        display.write_line(lines[line]);
+
+        // only the page of the new line is sent
+        REQUIRE(bus.write_count - writes == 2);
+        REQUIRE(bus.data_bytes - data_bytes == screen::width);
+
+        require_shown_lines(line);
+    }
+
+    REQUIRE(display.top_page() == 3);
+    REQUIRE(bus.start_line == 24);
+    REQUIRE(bus.unknown_commands == 0);
+
+    SECTION("Clear") {
+        display.clear();
+        display.flush();
+
+        REQUIRE(bus.start_line == 0);
+
+        display.write_line(lines[0]);
+        require_shown_lines(0);
+    }
+}
+
+/*
+ * Writes more lines than fit on the screen to a st7735 terminal, the
+ * emulated screen has to show the last lines and every line has to be sent
+ * on its own.
+ */
+template <class DisplayScreen, class Display>
+void require_terminal() {
+    using r2d2::display::st7735_emulator_c;
+
+    st7735_fixture_s<DisplayScreen, Display> fixture;
+    auto &emulator = fixture.emulator;
+    auto &display = fixture.display;
+
+    constexpr std::size_t lines = DisplayScreen::height / 8;
+    const uint16_t color = display.color_to_pixel(hwlib::white);
+
+    // the memory is mirrored, the rows below the screen are above it in the
+    // memory
+    const uint16_t top_fixed = st7735_emulator_c::memory_height -
+                               DisplayScreen::y_offset - DisplayScreen::height;
+
+    REQUIRE(emulator.top_fixed == top_fixed);
+    REQUIRE(emulator.scroll_height == DisplayScreen::height);
+
+    display.clear();
+    display.flush();
+
+    char text[] = "line 00";
+    for (std::size_t line = 0; line < lines + 5; line++) {
+        text[5] = '0' + (line / 10);
+        text[6] = '0' + (line % 10);
+
+        const std::size_t bytes = emulator.bytes_written;
+        const std::size_t commands = emulator.commands.size();
+        display.write_line(text);
+
+        // only the row of the new line is sent
+        REQUIRE(emulator.bytes_written - bytes <
+                (DisplayScreen::width * 8 * 2) + 64);
+
+        // a full terminal scrolls after the new line has been written
+        const auto sent = emulator.commands.begin() + commands;
+        const auto end = emulator.commands.end();
+        const auto scroll = std::find(sent, end, st7735_emulator_c::VSCRSADD);
+
+        if (line < lines) {
+            REQUIRE(scroll == end);
+        } else {
+            REQUIRE(scroll != end);
+            REQUIRE(std::find(sent, scroll, st7735_emulator_c::RAMWR) !=
+                    scroll);
+            REQUIRE(std::find(scroll, end, st7735_emulator_c::RAMWR) == end);
+        }
+    }
+
+    // the screen shows the last lines
+    for (std::size_t line = 0; line < lines; line++) {
+        text[5] = '0' + ((line + 5) / 10);
+        text[6] = '0' + ((line + 5) % 10);
+        fixture.reference.set_character(0, line * 8, text, color);
+    }
+
+    require_same_image(
+        [&](uint16_t x, uint16_t y) {
+            return emulator.shown_pixel(x, y, DisplayScreen::x_offset,
+                                        DisplayScreen::y_offset);
+        },
+        fixture.reference, same_pixel_s());
+    REQUIRE(display.top_line() == 5);
+
+    // lines written with a cursor scroll the screen as well
+    display.write_line(0, "cursor");
+    REQUIRE(display.top_line() == 6);
+
+    display.clear();
+    REQUIRE(display.top_line() == 0);
+    REQUIRE(emulator.scroll_start == top_fixed);
+}
+
+TEST_CASE("St7735 terminal", "[st7735]") {
+    using namespace r2d2::display;
+
+    SECTION("Buffered") {
+        require_terminal<
+            st7735_128x160_s,
+            st7735_terminal_c<st7735_buffered_c<st7735_128x160_s>>>();
+        require_terminal<
+            st7735_80x160_s,
+            st7735_terminal_c<st7735_buffered_c<st7735_80x160_s>>>();
+    }
+
+    SECTION("Unbuffered") {
+        require_terminal<
+            st7735_128x160_s,
+            st7735_terminal_c<st7735_unbuffered_c<st7735_128x160_s>>>();
+        require_terminal<
+            st7735_80x160_s,
+            st7735_terminal_c<st7735_unbuffered_c<st7735_80x160_s>>>();
+    }
+}
+
+TEST_CASE("St7735 partial mode", "[st7735]") {
+    using namespace r2d2::display;
+    using screen = st7735_80x160_s;
+
+    st7735_fixture_s<screen, st7735_buffered_c<screen>> fixture;
+    auto &emulator = fixture.emulator;
+    auto &display = fixture.display;
+
+    display.flush();
+    display.set_partial_area(8, 16);
+
+    REQUIRE(display.is_partial_mode());
+    REQUIRE(emulator.partial);
+    for (uint16_t y = 0; y < screen::height; y++) {
+        REQUIRE(emulator.row_shown(y, screen::y_offset) == (y >= 8 && y < 24));
+    }
+
+    // only the rows of the band are sent
+    const std::size_t bytes = emulator.bytes_written;
+    fixture.draw(draw_scene<screen>);
+
+    REQUIRE(emulator.bytes_written - bytes < (screen::width * 16 * 2) + 64);
+    require_same_image(emulator, fixture.reference, same_pixel_s(), 8, 24);
+
+    // the rest of the changes are sent in normal mode
+    display.set_normal_mode();
+    display.flush();
+
+    REQUIRE_FALSE(emulator.partial);
+    require_same_image(emulator, fixture.reference);
+}
+
+/*
+ * Draws the scene on an indexed st7735 driver and on the reference display.
+ * The reference keeps the pixel data, which the driver uses as palette
+ * index: the emulated memory has to be the color of the index in the default
+ * palette.
+ */
+template <class DisplayScreen, class Display>
+void require_indexed_golden_image() {
+    st7735_fixture_s<DisplayScreen, Display> fixture;
+
+    auto palette_color = [](uint16_t pixel) {
+        return Display::default_palette_color(pixel &
+                                              (Display::palette_size - 1));
+    };
+
+    for (auto draw : {draw_scene<DisplayScreen>, draw_changes<DisplayScreen>}) {
+        fixture.draw(draw);
+        require_same_image(fixture.emulator, fixture.reference, palette_color);
+    }
+
+    // clearing only clears the clip rectangle
+    fixture.draw([](r2d2::display::display_c<DisplayScreen> &display) {
+        display.set_clip(10, 20, 30, 40);
+        display.clear();
+        display.reset_clip();
+        display.flush();
+    });
+    require_same_image(fixture.emulator, fixture.reference, palette_color);
+
+    // a palette change recolours the whole screen
+    fixture.display.set_palette_color(Display::palette_size - 1, hwlib::red);
+    fixture.display.flush();
+
+    REQUIRE(fixture.emulator.pixel(0, 140 + DisplayScreen::y_offset,
+                                   DisplayScreen::x_offset) ==
+            r2d2::display::color_to_rgb565(hwlib::red));
+}
+
+TEST_CASE("St7735 indexed colors", "[st7735]") {
+    using namespace r2d2::display;
+
+    SECTION("8 bits per pixel") {
+        require_indexed_golden_image<
+            st7735_128x160_s, st7735_indexed_buffered_c<st7735_128x160_s, 8>>();
+    }
+
+    SECTION("4 bits per pixel") {
+        require_indexed_golden_image<
+            st7735_128x160_s, st7735_indexed_buffered_c<st7735_128x160_s, 4>>();
+        require_indexed_golden_image<
+            st7735_80x160_s, st7735_indexed_buffered_c<st7735_80x160_s, 4>>();
+    }
+
+    SECTION("2 bits per pixel") {
+        require_indexed_golden_image<
+            st7735_80x160_s, st7735_indexed_buffered_c<st7735_80x160_s, 2>>();
+    }
+
+    SECTION("RGB332") {
+        require_indexed_golden_image<st7735_128x160_s,
+                                     st7735_rgb332_buffered_c<st7735_128x160_s>>();
+
+        REQUIRE(color_to_rgb332(hwlib::white) == 0xFF);
+        REQUIRE(rgb332_to_rgb565(0xFF) == 0xFFFF);
+        REQUIRE(rgb332_to_rgb565(color_to_rgb332(hwlib::red)) ==
+                color_to_rgb565(hwlib::red));
+    }
+
+    SECTION("Closest color") {
+        st7735_emulator_c emulator;
+        auto pin_dummy = hwlib::pin_out_dummy;
+
+        st7735_indexed_buffered_c<st7735_80x160_s, 2> display(
+            emulator, pin_dummy, emulator.dc, pin_dummy);
+
+        REQUIRE(display.color_to_pixel(hwlib::black) == 0);
+        REQUIRE(display.color_to_pixel(hwlib::white) == 3);
+        REQUIRE(display.color_to_pixel(hwlib::color(90, 80, 85)) == 1);
+    }
+
+    SECTION("Buffer size") {
+        REQUIRE(sizeof(st7735_indexed_buffered_c<st7735_128x160_s, 4>) <
+                sizeof(st7735_buffered_c<st7735_128x160_s>) / 3);
+    }
+}
+
+/*
+ * Draws frames on a band renderer and on the reference display. The
+ * operations stay on the screen until the next clear, a flush only sends the
+ * bands that changed.
+ */
+template <class DisplayScreen, class Display>
+void require_band_frames() {
+    st7735_fixture_s<DisplayScreen, Display> fixture;
+
+    fixture.draw(draw_scene<DisplayScreen>);
+    require_same_image(fixture.emulator, fixture.reference);
+
+    // the changes are drawn over the scene
+    fixture.draw(draw_changes<DisplayScreen>);
+    require_same_image(fixture.emulator, fixture.reference);
+
+    // a frame with only the changes
+    fixture.draw([](auto &display) { display.clear(); });
+    fixture.draw(draw_changes<DisplayScreen>);
+    require_same_image(fixture.emulator, fixture.reference);
+
+    REQUIRE(fixture.display.get_overflows() == 0);
+
+    // bands that stay empty are not sent again
+    fixture.display.clear();
+    fixture.display.flush();
+
+    const std::size_t bytes = fixture.emulator.bytes_written;
+    fixture.display.clear();
+    fixture.display.flush();
+
+    REQUIRE(fixture.emulator.bytes_written == bytes);
+
+    // without drawing the screen is left alone
+    fixture.display.flush();
+    REQUIRE(fixture.emulator.bytes_written == bytes);
+}
+
+TEST_CASE("St7735 band renderer", "[st7735]") {
+    using namespace r2d2::display;
+
+    SECTION("Frames") {
+        require_band_frames<st7735_128x160_s,
+                            st7735_band_buffered_c<st7735_128x160_s>>();
+        require_band_frames<
+            st7735_80x160_s,
+            st7735_band_buffered_c<st7735_80x160_s, 24, 96, 512,
+                                   rgb565_native_s>>();
+    }
+
+    SECTION("Overflow") {
+        // the list and the pool are too small for the scene
+        st7735_fixture_s<st7735_80x160_s,
+                         st7735_band_buffered_c<st7735_80x160_s, 16, 4, 64>>
+            fixture;
+        auto &display = fixture.display;
+
+        display.flush();
+
+        // nothing is sent before the flush
+        const std::size_t bytes = fixture.emulator.bytes_written;
+        display.set_pixels(1, 1, 3, 3, uint16_t(0x8888));
+        display.set_character(40, 150, 'x', 0x0F0F);
+        display.set_pixels(st7735_80x160_s::width - 1, 90, 1, 1,
+                           uint16_t(0x1111));
+        display.set_pixels(0, 0, 4, 4, uint16_t(0xFFFF));
+        display.set_pixels(10, 10, 8, 8, uint16_t(0xFFFF));
+
+        uint16_t pixels[9 * 9] = {};
+        display.set_pixels(20, 20, 9, 9, pixels);
+        REQUIRE(fixture.emulator.bytes_written == bytes);
+
+        // the fifth operation and the block of 81 pixels didn't fit
+        REQUIRE(display.get_overflows() == 2);
+
+        // the operations that fit are drawn
+        display.flush();
+
+        fixture.reference.set_pixels(1, 1, 3, 3, uint16_t(0x8888));
+        fixture.reference.set_character(40, 150, 'x', 0x0F0F);
+        fixture.reference.set_pixels(st7735_80x160_s::width - 1, 90, 1, 1,
+                                     uint16_t(0x1111));
+        fixture.reference.set_pixels(0, 0, 4, 4, uint16_t(0xFFFF));
+        require_same_image(fixture.emulator, fixture.reference);
+
+        // a clear empties the list
+        display.clear();
+        display.set_pixels(10, 10, 8, 8, uint16_t(0xFFFF));
+        display.flush();
+
+        REQUIRE(display.get_overflows() == 2);
+    }
+
+    SECTION("Memory") {
+        REQUIRE(sizeof(st7735_band_buffered_c<st7735_128x160_s>) <
+                sizeof(st7735_buffered_c<st7735_128x160_s>) / 4);
+    }
+}
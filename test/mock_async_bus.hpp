@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <display_async_bus.hpp>
+#include <vector>
+
+namespace r2d2::display {
+    /**
+     * Async bus that completes a write in steps. Every call to poll sends a
+     * fixed amount of bytes, which are read from the data at that moment,
+     * like a DMA transfer would.
+     */
+    class mock_async_bus_c : public async_bus_c {
+    protected:
+        const uint8_t *data = nullptr;
+        std::size_t remaining = 0;
+        std::size_t step;
+
+    public:
+        // All bytes that have been sent
+        std::vector<uint8_t> written;
+
+        // The amount of writes that have been started
+        std::size_t write_count = 0;
+
+        // The amount of calls to poll
+        std::size_t poll_count = 0;
+
+        /**
+         * @param step The amount of bytes sent for every call to poll
+         */
+        mock_async_bus_c(std::size_t step = 64) : step(step) {
+        }
+
+        void begin_write(const uint8_t *data, std::size_t size) override {
+            this->data = data;
+            remaining = size;
+            write_count++;
+        }
+
+        bool poll() override {
+            const std::size_t count = remaining < step ? remaining : step;
+
+            written.insert(written.end(), data, data + count);
+            data += count;
+            remaining -= count;
+            poll_count++;
+
+            return remaining == 0;
+        }
+    };
+} // namespace r2d2::display
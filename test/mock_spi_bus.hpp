@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * Chip select pin that counts the transactions on a spi bus, every
+     * transaction starts by pulling the pin low.
+     */
+    class mock_cs_pin_c : public hwlib::pin_out {
+    public:
+        // The amount of transactions that have been started
+        std::size_t transactions = 0;
+
+        void write(bool v) override {
+            if (!v) {
+                transactions++;
+            }
+        }
+    };
+
+    /**
+     * Spi bus that only counts the bytes that are written to it. The
+     * transactions are counted by cs, when it is used as the chip select pin
+     * of the driver.
+     */
+    class mock_spi_bus_c : public hwlib::spi_bus {
+    protected:
+        void write_and_read(const size_t n, const uint8_t[],
+                            uint8_t[]) override {
+            bytes_written += n;
+        }
+
+    public:
+        // The amount of bytes written to the bus
+        std::size_t bytes_written = 0;
+
+        // Chip select pin that counts the transactions on the bus
+        mock_cs_pin_c cs;
+    };
+} // namespace r2d2::display
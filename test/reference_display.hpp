@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <display_adapter.hpp>
+#include <display_pixel_format.hpp>
+#include <hwlib.hpp>
+
+namespace r2d2::display {
+    /**
+     * Display that stores every pixel in memory and only implements
+     * set_pixel, so everything is drawn through the simple paths of
+     * display_c. The image is the reference the drivers are compared with.
+     *
+     * @tparam DisplayScreen One of the display structs from display_screen.hpp
+     * @tparam PixelFormat Converts the colors, see display_pixel_format.hpp
+     */
+    template <class DisplayScreen, class PixelFormat = rgb565_native_s>
+    class reference_display_c : public display_c<DisplayScreen> {
+    public:
+        uint16_t pixels[DisplayScreen::width * DisplayScreen::height] = {};
+
+        reference_display_c()
+            : display_c<DisplayScreen>(
+                  hwlib::xy(DisplayScreen::width, DisplayScreen::height)) {
+        }
+
+        uint16_t color_to_pixel(hwlib::color col) override {
+            return PixelFormat::from_color(col);
+        }
+
+        void set_pixel(uint16_t x, uint16_t y, const uint16_t data) override {
+            pixels[x + (y * DisplayScreen::width)] = data;
+        }
+
+        /**
+         * @brief Returns a pixel of the image
+         *
+         * @param x
+         * @param y
+         */
+        uint16_t pixel(uint16_t x, uint16_t y) const {
+            return pixels[x + (y * DisplayScreen::width)];
+        }
+    };
+} // namespace r2d2::display
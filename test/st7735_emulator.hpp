@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <hwlib.hpp>
+#include <vector>
+
+namespace r2d2::display {
+    /**
+     * Spi bus that decodes the command stream of the st7735 into an emulated
+     * display memory, so tests can check what a driver actually sends.
+     *
+     * The data/command pin of the driver has to be the dc pin of the
+     * emulator. CASET, RASET and RAMWR are emulated like the chip does,
+     * including the wrap around in the address window. The row/column
+     * exchange and the row mirroring (MY) of MADCTL change how the memory is
+     * addressed, with MY the first row the driver writes is the last row of
+     * the memory. COLMOD and the inversion commands are only stored.
+     *
+     * The screen shows the rows of the memory in the order the driver writes
+     * them, so pixel() reads the memory in the coordinates of the driver.
+     * VSCRDEF, VSCRSADD and PTLAR use the rows of the memory like the chip
+     * does: VSCRDEF and VSCRSADD define which rows of the memory are shown on
+     * the screen, PTLAR, PTLON and NORON which rows are shown at all.
+     */
+    class st7735_emulator_c : public hwlib::spi_bus {
+    public:
+        // the size of the memory of the st7735
+        constexpr static uint16_t memory_width = 132;
+        constexpr static uint16_t memory_height = 162;
+
+        constexpr static uint8_t CASET = 0x2A;
+        constexpr static uint8_t RASET = 0x2B;
+        constexpr static uint8_t RAMWR = 0x2C;
+        constexpr static uint8_t MADCTL = 0x36;
+        constexpr static uint8_t COLMOD = 0x3A;
+        constexpr static uint8_t INVOFF = 0x20;
+        constexpr static uint8_t INVON = 0x21;
+        constexpr static uint8_t NORON = 0x13;
+        constexpr static uint8_t PTLON = 0x12;
+        constexpr static uint8_t PTLAR = 0x30;
+        constexpr static uint8_t VSCRDEF = 0x33;
+        constexpr static uint8_t VSCRSADD = 0x37;
+
+        // row/column exchange and row mirror bits of MADCTL
+        constexpr static uint8_t MADCTL_MV = 0x20;
+        constexpr static uint8_t MADCTL_MY = 0x80;
+
+        /**
+         * The data/command pin, high for data
+         */
+        class dc_pin_c : public hwlib::pin_out {
+        public:
+            bool level = false;
+
+            void write(bool v) override {
+                level = v;
+            }
+        };
+
+        dc_pin_c dc;
+
+        // the emulated display memory
+        uint16_t memory[memory_width * memory_height] = {};
+
+        // the address window
+        uint16_t x_start = 0;
+        uint16_t x_end = memory_width - 1;
+        uint16_t y_start = 0;
+        uint16_t y_end = memory_height - 1;
+
+        uint8_t madctl = 0;
+        uint8_t colmod = 0;
+        bool inverted = false;
+
+        // the vertical scroll area and the row shown at the top of it
+        uint16_t top_fixed = 0;
+        uint16_t scroll_height = memory_height;
+        uint16_t scroll_start = 0;
+
+        // the rows of the memory that are shown in partial mode
+        uint16_t partial_start = 0;
+        uint16_t partial_end = memory_height - 1;
+        bool partial = false;
+
+        // the amount of pixels that were written after the address window
+        // wrapped around, a driver should never do that
+        std::size_t wrapped_pixels = 0;
+
+        // the amount of bytes received
+        std::size_t bytes_written = 0;
+
+        // every command received, in the order they were sent
+        std::vector<uint8_t> commands;
+
+        /**
+         * @brief Returns the row of the memory a row the driver writes to is
+         * stored in
+         *
+         * @param y
+         */
+        uint16_t memory_row(uint16_t y) const {
+            return (madctl & MADCTL_MY) ? memory_height - 1 - y : y;
+        }
+
+        /**
+         * @brief Returns a pixel in the coordinates the driver uses, the
+         * offset of the screen is added
+         *
+         * @param x
+         * @param y
+         */
+        uint16_t pixel(uint16_t x, uint16_t y, uint8_t x_offset = 0,
+                       uint8_t y_offset = 0) const {
+            return memory[(x + x_offset) +
+                          (memory_row(y + y_offset) * memory_width)];
+        }
+
+        /**
+         * @brief Returns a pixel as it is shown on the screen, the vertical
+         * scroll area is applied
+         *
+         * @param x
+         * @param y
+         */
+        uint16_t shown_pixel(uint16_t x, uint16_t y, uint8_t x_offset = 0,
+                             uint8_t y_offset = 0) const {
+            uint16_t row = memory_row(y + y_offset);
+
+            if (row >= top_fixed && row < top_fixed + scroll_height) {
+                row = top_fixed + ((row - top_fixed) +
+                                   (scroll_start - top_fixed)) %
+                                      scroll_height;
+            }
+
+            return memory[(x + x_offset) + (row * memory_width)];
+        }
+
+        /**
+         * @brief Returns true when a row in the coordinates the driver uses
+         * is shown, in partial mode only the rows of the partial area are
+         *
+         * @param y
+         */
+        bool row_shown(uint16_t y, uint8_t y_offset = 0) const {
+            const uint16_t row = memory_row(y + y_offset);
+            return !partial || (row >= partial_start && row <= partial_end);
+        }
+
+    protected:
+        // the last command and the amount of parameters received for it
+        uint8_t command = 0;
+        std::size_t parameter = 0;
+        uint8_t parameters[6] = {};
+
+        // the position of the next pixel of RAMWR
+        uint16_t x = 0;
+        uint16_t y = 0;
+
+        // the first byte of a pixel that has been received
+        uint8_t pixel_high = 0;
+        bool pixel_started = false;
+
+        // true when the whole window has been written
+        bool window_full = false;
+
+        void write_pixel(uint16_t data) {
+            if (window_full) {
+                wrapped_pixels++;
+            }
+
+            uint16_t column = x;
+            uint16_t row = y;
+
+            if (madctl & MADCTL_MV) {
+                column = y;
+                row = x;
+            }
+
+            if (column < memory_width && row < memory_height) {
+                row = memory_row(row);
+                memory[column + (row * memory_width)] = data;
+            }
+
+            // move to the next pixel of the window
+            if (x < x_end) {
+                x++;
+                return;
+            }
+
+            x = x_start;
+            if (y < y_end) {
+                y++;
+                return;
+            }
+
+            y = y_start;
+            window_full = true;
+        }
+
+        void write_command(uint8_t value) {
+            commands.push_back(value);
+            command = value;
+            parameter = 0;
+            pixel_started = false;
+
+            switch (command) {
+                case RAMWR:
+                    x = x_start;
+                    y = y_start;
+                    window_full = false;
+                    break;
+                case INVON:
+                    inverted = true;
+                    break;
+                case INVOFF:
+                    inverted = false;
+                    break;
+                case PTLON:
+                    partial = true;
+                    break;
+                case NORON:
+                    partial = false;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void write_data(uint8_t value) {
+            if (command == RAMWR) {
+                // the first byte of a pixel is the most significant
+                if (!pixel_started) {
+                    pixel_high = value;
+                    pixel_started = true;
+                } else {
+                    write_pixel((uint16_t(pixel_high) << 8) | value);
+                    pixel_started = false;
+                }
+                return;
+            }
+
+            if (parameter < sizeof(parameters)) {
+                parameters[parameter] = value;
+            }
+            parameter++;
+
+            switch (command) {
+                case CASET:
+                    if (parameter == 4) {
+                        x_start = (parameters[0] << 8) | parameters[1];
+                        x_end = (parameters[2] << 8) | parameters[3];
+                    }
+                    break;
+                case RASET:
+                    if (parameter == 4) {
+                        y_start = (parameters[0] << 8) | parameters[1];
+                        y_end = (parameters[2] << 8) | parameters[3];
+                    }
+                    break;
+                case MADCTL:
+                    madctl = value;
+                    break;
+                case PTLAR:
+                    if (parameter == 4) {
+                        partial_start = (parameters[0] << 8) | parameters[1];
+                        partial_end = (parameters[2] << 8) | parameters[3];
+                    }
+                    break;
+                case VSCRDEF:
+                    if (parameter == 6) {
+                        top_fixed = (parameters[0] << 8) | parameters[1];
+                        scroll_height = (parameters[2] << 8) | parameters[3];
+                    }
+                    break;
+                case VSCRSADD:
+                    if (parameter == 2) {
+                        scroll_start = (parameters[0] << 8) | parameters[1];
+                    }
+                    break;
+                case COLMOD:
+                    colmod = value;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void write_and_read(const size_t n, const uint8_t data_out[],
+                            uint8_t[]) override {
+            bytes_written += n;
+
+            for (std::size_t i = 0; i < n; i++) {
+                if (dc.level) {
+                    write_data(data_out[i]);
+                } else {
+                    write_command(data_out[i]);
+                }
+            }
+        }
+    };
+} // namespace r2d2::display